@@ -20,29 +20,124 @@
  *   make
  *   If you don't have gcc, you may need to find an alternative to __builtin_ctz
  * Run as:
- *   ./mcf [<num_inputs> [<num_outputs>]]
+ *   ./mcf [<options>] [<num_inputs> [<num_outputs>]]
  * Faster version (less checks, worse debuggablity):
- *   make mcf_fast && ./mcf_fast [<num_inputs> [<num_outputs>]]
+ *   make mcf_fast && ./mcf_fast [<options>] [<num_inputs> [<num_outputs>]]
  * Where:
  * - <num_inputs> is the number of binary inputs.  Defaults to 3.
  * - <num_outputs> is the number of binary outputs.  Defaults to 3.
+ * - <options> may be any of:
+ *   --threads <n>  Search with <n> threads.  0 means "one per core".
+ *                  Defaults to 1.  Output is the same in any case, but
+ *                  only appears at the very end (see 'print_parallel').
+ *                  Can't be combined with --checkpoint, --binary, --limit
+ *                  or --progress.
+ *   --checkpoint <file>  Save progress to <file> every 10 minutes (or see
+ *                  --checkpoint-interval <seconds>), and when done.
+ *   --resume       Continue from the checkpoint <file>, bit-exactly.
+ *                  Output before the checkpoint is not repeated.
+ *   --progress <seconds>  Print a line of JSON to stderr every <seconds>
+ *                  seconds, see 'progress_reporter'.  Off by default.  Its
+ *                  'covered' is only a rough estimate (see
+ *                  'progress_gauge'), and takes some probes to compute.
+ *   --separate     Use the separate analyzers, as a reference for the (by
+ *                  default) fused analyzer.  Same output, but slower.
+ *   --pipeline     Use the separate analyzers, but chained at compile time
+ *                  instead of through a list of virtual calls (see
+ *                  'pipeline').  Same output, somewhat faster than
+ *                  --separate.
+ *   --generic      Use the fused analyzer with run-time dimensions, even if
+ *                  there is a compile-time one.  (There is none, unless
+ *                  built with MCF_FIXED_MAX_INPUTS/_OUTPUTS.)  Also, store
+ *                  each place of the image in a full 'myint', instead of one
+ *                  or two bytes (see 'place_for').
+ *   --sliced       Also store the image bit-sliced, one bitmask per output
+ *                  pin, and use the separate analyzers rewritten for that
+ *                  (see 'sliced_function').  Same output.
+ *   --input-order  Only print the first function of each class under
+ *                  permutations of the input pins.  (Up to 7 inputs, see
+ *                  MAX_PERMUTED_INPUTS.)
+ *   --input-flips  Only print the first function of each class under
+ *                  flipping input pins (and XOR-ing the outputs, so that
+ *                  f(0) is 0 again).  Together with --input-order, under
+ *                  both.  (Up to 10 inputs, or 6 with --input-order.)
+ *   --no-copies    Skip functions where an output pin is just a copy of an
+ *                  input pin.
+ *   --count-classes  Don't print the functions, only count them, and the
+ *                  classes under --input-order and/or --input-flips (which
+ *                  are required), using Burnside's lemma.  See
+ *                  'print_classes'.
+ *   --admissible   Right after advancing, skip values that differ in more
+ *                  than one output pin from a lower neighbour (see
+ *                  'advance_admissible').  Same output, fewer steps.
+ *   --count-only   Don't print the functions, only count them.  Much faster
+ *                  if there are many.
+ *   --limit <n>    Stop after finding <n> functions in total.  Together with
+ *                  --checkpoint, the search can be resumed later.
+ *   --binary       Print found functions in a compact binary format (see
+ *                  'write_binary'), through a big buffer.  Not with
+ *                  --count-only, of course.
+ *   --decode       Don't search at all.  Instead, read binary output from
+ *                  stdin, and print it just like the search would have.
+ *   --estimate <probes>  Don't search at all.  Instead, estimate how many
+ *                  functions and steps the search would take, from <probes>
+ *                  random descents through the search tree (see
+ *                  'estimator').  Some 10000 probes are a good start.
+ *   --profile      Print statistics about each analyzer when done: calls,
+ *                  cycles (or nanoseconds, off x86) per call,
+ *                  and how often (and how far) it made the search jump.
+ *                  Note that the default fused analyzer and --pipeline
+ *                  count as a single analyzer each, so use --separate to
+ *                  see which of output ordering, metastability-containment
+ *                  and input relevance does the pruning.
+ *   --shard <k>/<n>  Only search the <k>-th of <n> parts (counting from 0),
+ *                  and write it down for --merge instead of the usual
+ *                  output.  Runs single-threaded, and without --checkpoint,
+ *                  --binary or --limit.
+ *   --make-plan <n>  Don't search, but write a plan for <n> shards of about
+ *                  the same (estimated) size to stdout.  See 'planner'.
+ *   --plan <file>  With --shard, use the ranges from that plan instead of
+ *                  an even split.
+ *   --merge <files...>  Combine the outputs of all --shard runs into exactly
+ *                  what a single run would have printed.  Takes all further
+ *                  arguments as file names.
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include <boost/io/ios_state.hpp>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define MCF_HAVE_RDTSC
+#endif
+
 
 /* ----- Things that will be everywhere ----- */
 
 typedef unsigned int myint;
+/* Several most significant places of an image, see function::get_prefix. */
+typedef unsigned long long prefix_t;
 /* The program will take up to O(MAX_BITS**MAX_BITS) time,
  * so I don't think you're going to need more than that 20.  */
 #define MAX_BITS 20
@@ -56,7 +151,8 @@ myint pin2mask(const myint pin) {
     return static_cast<myint>(1) << pin;
 }
 
-class function;
+template <typename place_t>
+class basic_function;
 
 struct bit_address {
     /* What's the lowest input-pattern that upset this analyzer?
@@ -74,7 +170,8 @@ struct bit_address {
     }
 
     // Convenience: not upset
-    bit_address(const function& f);
+    template <typename place_t>
+    bit_address(const basic_function<place_t>& f);
     /*Must come after the definition of class function.  Sigh. */
 
     // Collapse default operator= and hand-written std::min overload
@@ -92,22 +189,27 @@ struct bit_address {
     }
 };
 
-/* Glorified std::vector<myint>. Also, glorified BigNum. */
-class function {
+/* Glorified std::vector<myint>. Also, glorified BigNum.
+ * Each place is stored as a 'place_t', which only needs to hold values below
+ * 'end_output'.  Smaller types mean that the scans of the image touch less
+ * cache; see 'place_for'. */
+template <typename place_t>
+class basic_function {
 public:
-    typedef std::vector<myint> image_t;
+    typedef std::vector<place_t> image_t;
     const myint num_inputs;
     const myint num_outputs;
     const myint end_input;
     const myint end_output;
     image_t image;
 
-    function(const myint num_inputs, const myint num_outputs) :
+    basic_function(const myint num_inputs, const myint num_outputs) :
             num_inputs(num_inputs), num_outputs(num_outputs),
             end_input(pin2mask(num_inputs)), end_output(pin2mask(num_outputs)),
             image(end_input) {
         assert(num_inputs > 0);
         assert(num_outputs > 0);
+        assert(end_output - 1 == static_cast<place_t>(end_output - 1));
     }
 
     /* "Count up".  Note that we're treating 'image' as a very large number:
@@ -138,10 +240,12 @@ public:
         // Increment image[at], with carry:
         for (myint i = at.input_pattern; i >= 1; --i) {
             /* ↑ Consider only functions that map 0 to 0.
-             * Thus, never change image[0]. */
-            ++image[i];
-            if (image[i] < end_output) {
+             * Thus, never change image[0].
+             * Note that 'end_output' itself might not fit into a place_t. */
+            const myint incremented = image[i] + 1;
+            if (incremented < end_output) {
                 // Valid!
+                image[i] = static_cast<place_t>(incremented);
                 return i;
             } else {
                 // Wrap-around of this digit.
@@ -152,9 +256,102 @@ public:
          * (Ignoring image[0] of course; see above.) */
         return end_input;
     }
+
+    /* Same as 'advance', but then also skips all values of the changed
+     * place that differ in more than one output pin from one of its lower
+     * neighbours.  Those are all fixed already, so such a function can't
+     * possibly be metastability-containing, and there's no point in asking
+     * the analyzers about it.  (This also covers
+     * 'popcount(f(i)) <= popcount(i)', by induction.)  If no value is left,
+     * carry over into the next more significant place, and try again there.
+     * Just like 'advance', this leaves all later places at 0. */
+    myint advance_admissible(const bit_address at) {
+        myint changed = advance(at);
+        while (changed < end_input) {
+            const myint value = next_admissible(changed, image[changed]);
+            if (value < end_output) {
+                image[changed] = static_cast<place_t>(value);
+                break;
+            }
+            changed = advance(bit_address(changed - 1, 0));
+        }
+        return changed;
+    }
+
+    /* Replaces the whole image, e.g. to continue somewhere else. */
+    template <typename iterator_t>
+    void set_image(const iterator_t begin, const iterator_t end) {
+        image.assign(begin, end);
+    }
+
+    /* The smallest value of at least 'from' that differs in at most one
+     * output pin from all lower neighbours of 'place', or 'end_output' if
+     * there is none.  It must be within one pin of *some* neighbour, so
+     * there are only 'num_outputs + 1' candidates to check. */
+    myint next_admissible(const myint place, const myint from) const {
+        assert(place > 0 && place < end_input);
+        const myint lowest = place & (~place + 1);
+        const myint anchor = image[place ^ lowest];
+        myint best = end_output;
+        for (myint out_pin = 0; out_pin <= num_outputs; ++out_pin) {
+            const myint candidate = (out_pin < num_outputs)
+                    ? anchor ^ pin2mask(out_pin) : anchor;
+            if (candidate < from || candidate >= best) {
+                continue;
+            }
+            bool fine = true;
+            for (myint rest = place ^ lowest; rest && fine;
+                    rest &= rest - 1) {
+                const myint change = candidate
+                        ^ image[place & ~(rest & (~rest + 1))];
+                fine = (change & (change - 1)) == 0;
+            }
+            if (fine) {
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    /* Interpret the 'depth' most significant places (ignoring image[0],
+     * which never changes) as a single number, i.e., 'image[depth]' is the
+     * least significant "digit" of the prefix. */
+    prefix_t get_prefix(const myint depth) const {
+        assert(depth < end_input);
+        prefix_t prefix = 0;
+        for (myint i = 1; i <= depth; ++i) {
+            prefix = prefix * end_output + image[i];
+        }
+        return prefix;
+    }
+
+    /* Inverse of 'get_prefix'.  Resets all less significant places to 0,
+     * just like 'advance' would do when entering this prefix. */
+    void set_prefix(const myint depth, prefix_t prefix) {
+        assert(depth < end_input);
+        for (myint i = end_input - 1; i > depth; --i) {
+            image[i] = 0;
+        }
+        for (myint i = depth; i >= 1; --i) {
+            image[i] = static_cast<place_t>(prefix % end_output);
+            prefix /= end_output;
+        }
+        assert(prefix == 0);
+    }
 };
 
-bit_address::bit_address(const function& f) :
+typedef basic_function<myint> function;
+
+/* Smallest type that can hold a place of a function with N_OUT outputs. */
+template <myint N_OUT>
+struct place_for {
+    typedef typename std::conditional<N_OUT <= 8, std::uint8_t,
+            typename std::conditional<N_OUT <= 16, std::uint16_t, myint>::type
+            >::type type;
+};
+
+template <typename place_t>
+bit_address::bit_address(const basic_function<place_t>& f) :
         input_pattern(f.end_input)
 #ifndef MCF_ALLOW_UNINITIALIZED
         , bit(0)
@@ -173,7 +370,8 @@ myint parse_arg(char *arg) {
     return static_cast<unsigned int>(raw_val);
 }
 
-std::ostream& operator<<(std::ostream& out, const function& f) {
+template <typename place_t>
+std::ostream& operator<<(std::ostream& out, const basic_function<place_t>& f) {
     out << "fn(B^" << f.num_inputs << " -> B^" << f.num_outputs << ")";
 
     if (f.image.size() == 0) {
@@ -181,7 +379,7 @@ std::ostream& operator<<(std::ostream& out, const function& f) {
         out << "[]";
     } else if (f.image.size() == 1) {
         // Uhhhhh.
-        out << "[" << f.image[0] << "]";
+        out << "[" << static_cast<myint>(f.image[0]) << "]";
     } else {
         // Thanks.
 
@@ -195,10 +393,13 @@ std::ostream& operator<<(std::ostream& out, const function& f) {
         const myint out_w = (f.num_outputs + 3) / 4;
         out << std::hex;
 
-        out << "[" << std::setw(out_w) << f.image[0];
+        /* Careful: a place_t might be a char type, which iostream would
+         * print as a character. */
+        out << "[" << std::setw(out_w) << static_cast<myint>(f.image[0]);
         for (myint i = 1; i < f.image.size(); ++i) {
             // Yuk, formatting with iostream.
-            out << std::setw(0) << ", " << std::setw(out_w) << f.image[i];
+            out << std::setw(0) << ", " << std::setw(out_w)
+                    << static_cast<myint>(f.image[i]);
         }
         out << std::setw(0) << "]";
     }
@@ -216,64 +417,88 @@ std::ostream& operator<<(std::ostream& out, const bit_address& at) {
 
 /* ----- Central superclass / interface ----- */
 /* Note that each analyzer shall have the ability to retain state,
- * so I prefer this abstract class over functors.  Also, I get away
- * without having to write a template, which is nice. */
+ * so I prefer this abstract class over functors.  Also, I almost get away
+ * without having to write a template, which is nice.  (Only the storage of
+ * the function's image varies; most analyzers only care about 'function'.) */
 
-class analyzer {
+template <typename function_t>
+class basic_analyzer {
 public:
-    constexpr analyzer() = default;
+    constexpr basic_analyzer() = default;
 
-    virtual ~analyzer() = default;
+    virtual ~basic_analyzer() = default;
 
     /* Gets the most significant place that changed since the last invocation;
      * or 0 if there was no last invocation.  (Which fits well because then you
      * can treat that as the same case.)
      * Returns either the most significant place that has to be increased,
      * before this analyzer is satisfied -- or 'f.end_input' if satisfied. */
-    virtual bit_address analyze(const function& f, const myint first_changed) = 0;
+    virtual bit_address analyze(const function_t& f,
+            const myint first_changed) = 0;
 
     virtual const std::string& get_name() const = 0;
+
+    /* The verdict of the last 'analyze' call (and the state) only depends on
+     * the places before this one.  So while none of them changes, the
+     * searcher may skip calling 'analyze' and reuse that verdict; see
+     * 'verdict_cache'.  In that case, the next call gets the most significant
+     * place that changed during all the skipped steps, as promised above.
+     * When in doubt, depend on everything. */
+    virtual myint settled_before(const function_t& f) const {
+        return f.end_input;
+    }
+
+    /* Writes the incremental state to 'out', on a single line, such that
+     * 'load' can restore it exactly.  Stateless analyzers have nothing to
+     * say. */
+    virtual void save(std::ostream&) const {
+    }
+
+    /* Inverse of 'save'.  Throws std::runtime_error if the state is garbage
+     * or doesn't fit 'f'. */
+    virtual void load(std::istream&, const function_t&) {
+    }
 };
 
+typedef basic_analyzer<function> analyzer;
+
+template <typename function_t>
+using basic_properties = std::vector<std::unique_ptr<basic_analyzer<function_t>>>;
+typedef basic_properties<function> properties_t;
+
 
 /* ----- Useful analyzers ----- */
 /* Each of these represents a criterion a function needs to fulfill.
- * TODO/benchmark: Combine/inline all this into a single loop over all inputs?
- * However, for maintenance/development, the current structure is better. */
+ * For maintenance/development, this structure is best.  However, combining
+ * all this into a single loop over all inputs is faster; see
+ * 'fused_analyzer'. */
 
-/* Check if the function is metastability-containing.  Duh. */
+/* Check if the function is metastability-containing.  Duh.
+ *
+ * This only compares each place to its lower neighbours, but that already
+ * covers 'hamming(f(x), f(y)) <= hamming(x, y)' for all pairs:  'x & y' comes
+ * before both, and there's a path from it up to each of them, one pin at a
+ * time, that never goes past 'max(x, y)'.  So a pair that breaks this is
+ * reported at 'max(x, y)' or earlier anyway, and checking pairs at distance
+ * 2 (or more) separately can't ever cut the search sooner. */
 class metastability_containing: public analyzer {
 public:
     // Stateless, modulo vtable entries
     constexpr metastability_containing() = default;
 
+    // For 'pipeline'.
+    explicit metastability_containing(const function&) {
+    }
+
     virtual ~metastability_containing() = default;
 
     virtual bit_address analyze(const function& f, const myint first_changed) {
         // 'first_changed==0' is rare enough (once) to need no extra filtering.
         for (myint i = first_changed; i < f.end_input; ++i) {
-            const myint output = f.image[i];
-            myint max_tz_plus_one = 0;
-            for (myint j = f.num_inputs; j > 0; --j) {
-                const myint in_pin = j - 1;
-                // Affected bits if in-pin is 'M':
-                const myint change = output ^ f.image[i & ~pin2mask(in_pin)];
-                if (is_pot_or_zero(change)) {
-                    // It's good.
-                    continue;
-                }
-                /* Not containing!  More than one output changes!  In order to
-                 * fix this, *at least* the least significant offending output
-                 * pin must change.  However, we want to look at all input pins
-                 * and choose the most significant pin of all least significant
-                 * offending pins.
-                 * In case you're trying to get rid of __builtin_ctz, don't
-                 * worry:  it will never be called with 0. */
-                max_tz_plus_one = std::max(max_tz_plus_one,
-                        myint(__builtin_ctz(change) + 1));
-            }
-            if (max_tz_plus_one) {
-                return bit_address(i, max_tz_plus_one - 1);
+            const myint bit_plus_one =
+                    bad_bit_plus_one(f.image.data(), f.num_inputs, i);
+            if (bit_plus_one) {
+                return bit_address(i, bit_plus_one - 1);
             }
         }
         // Fine!
@@ -285,15 +510,44 @@ public:
         return name;
     }
 
-private:
-    /* Is 'v' a power of two, or zero? */
+    /* Is 'v' a power of two, or zero?
+     * Public, as 'fused_analyzer' needs this, too. */
     static bool is_pot_or_zero(const myint v) {
         // Based on:
         // https://graphics.stanford.edu/~seander/bithacks.html#DetermineIfPowerOf2
         return (v & (v - 1)) == 0;
     }
+
+    /* Which bit (plus one) needs to change at place 'i', or 0 if place 'i'
+     * is fine.  Public, as 'sliced_metastability_containing' needs this,
+     * too. */
+    static myint bad_bit_plus_one(const myint* image, const myint num_inputs,
+            const myint i) {
+        const myint output = image[i];
+        myint max_tz_plus_one = 0;
+        for (myint j = num_inputs; j > 0; --j) {
+            const myint in_pin = j - 1;
+            // Affected bits if in-pin is 'M':
+            const myint change = output ^ image[i & ~pin2mask(in_pin)];
+            if (is_pot_or_zero(change)) {
+                // It's good.
+                continue;
+            }
+            /* Not containing!  More than one output changes!  In order to
+             * fix this, *at least* the least significant offending output
+             * pin must change.  However, we want to look at all input pins
+             * and choose the most significant pin of all least significant
+             * offending pins.
+             * In case you're trying to get rid of __builtin_ctz, don't
+             * worry:  it will never be called with 0. */
+            max_tz_plus_one = std::max(max_tz_plus_one,
+                    myint(__builtin_ctz(change) + 1));
+        }
+        return max_tz_plus_one;
+    }
 };
 
+
 /* Check that each input pin is relevant.  An input pin is relevant *iff* there
  * are two inputs x, y only differing on the state of that input pin,
  * and f(x) != f(y). */
@@ -336,10 +590,15 @@ public:
                     continue;
                 }
                 const myint opposite_input = i & ~pin2mask(in_pin);
-                // f.image[opposite_input] destroys all kinds of locality :/
-                // TODO/benchmark: Hilbert walk the image????
-                // This would require A LOT changes.
-                // TODO/benchmark: merge classes with metastability_containing?
+                /* f.image[opposite_input] is 2**in_pin places away, which
+                 * looked like it destroys all kinds of locality.  But the
+                 * natural order already is the recursive cube order: each
+                 * subcube of the low pins is contiguous.  A Gray code (or
+                 * Hilbert) order would be no better, and worse, it visits
+                 * some patterns before their lower neighbours (3 before 2),
+                 * which all analyzers rely on.  Anyway, a whole image is at
+                 * most a few hundred bytes in practice, so it never leaves
+                 * L1.  See README, "Missing optimizations". */
                 if (output != f.image[opposite_input]) {
                     // Relevant!
                     first_relevant[in_pin] = i;
@@ -363,6 +622,40 @@ public:
         return name;
     }
 
+    /* Once every input is relevant, nothing after that matters anymore. */
+    virtual myint settled_before(const function& f) const {
+        if (relevant_inputs < f.num_inputs) {
+            return f.end_input;
+        }
+        myint last = 0;
+        for (const myint first : first_relevant) {
+            last = std::max(last, first);
+        }
+        return last + 1;
+    }
+
+    virtual void save(std::ostream& out) const {
+        out << relevant_inputs;
+        for (const myint first : first_relevant) {
+            out << ' ' << first;
+        }
+    }
+
+    virtual void load(std::istream& in, const function& f) {
+        myint count = 0;
+        in >> relevant_inputs;
+        for (myint& first : first_relevant) {
+            in >> first;
+            if (first > f.end_input) {
+                throw std::runtime_error("in_rel: pattern out of range");
+            }
+            count += (first != f.end_input);
+        }
+        if (!in || count != relevant_inputs) {
+            throw std::runtime_error("in_rel: inconsistent state");
+        }
+    }
+
 private:
     // On which input-pattern was the i-th input-pin first relevant?
     std::vector<myint> first_relevant;
@@ -492,6 +785,41 @@ public:
         return name;
     }
 
+    /* Once every output pin has its first one, the rest is someone else's
+     * problem. */
+    virtual myint settled_before(const function& f) const {
+        if (first_ones.size() < f.num_outputs) {
+            return f.end_input;
+        }
+        return first_ones.back() + 1;
+    }
+
+    virtual void save(std::ostream& out) const {
+        out << first_ones.size();
+        for (const myint first : first_ones) {
+            out << ' ' << first;
+        }
+    }
+
+    virtual void load(std::istream& in, const function& f) {
+        size_t size = 0;
+        in >> size;
+        if (!in || size > f.num_outputs) {
+            throw std::runtime_error("out_ord: too many first ones");
+        }
+        first_ones.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            in >> first_ones[i];
+            if (first_ones[i] >= f.end_input
+                    || (i > 0 && first_ones[i - 1] >= first_ones[i])) {
+                throw std::runtime_error("out_ord: first ones not ordered");
+            }
+        }
+        if (!in) {
+            throw std::runtime_error("out_ord: truncated state");
+        }
+    }
+
     /* Must be public, as the constructor would like to have that property
      * already.  And *that* can only be guaranteed if print_remaining checks
      * it. */
@@ -531,119 +859,3339 @@ private:
 };
 
 
-/* ----- Combining it all ----- */
+/* Check that no output pin merely copies an input pin.  Note that due to
+ * f(0) == 0, an output pin that depends on only one input pin (and is
+ * relevant, see 'output_ordered') can't be anything but a copy of it.
+ * Such output pins are boring, as they are trivially
+ * metastability-containing.
+ *
+ * Just like 'input_relevance', this can only be sure at the very last place.
+ * However, a copy of an input pin must be 1 at the all-ones pattern, so at
+ * least all values with that bit still set can be skipped. */
+template <typename function_t>
+class basic_no_copies: public basic_analyzer<function_t> {
+public:
+    basic_no_copies(const function_t& f) :
+            first_mismatch(f.num_outputs * f.num_inputs, f.end_input),
+            copying(f.num_inputs, f.end_output - 1),
+            num_copying(f.num_outputs * f.num_inputs) {
+    }
 
-const static bool DEBUG_PRINT = false;
+    virtual ~basic_no_copies() = default;
 
-const static myint DEBUG_PRINT_STEP = 5000000;
+    virtual bit_address analyze(const function_t& f,
+            const myint first_changed) {
+        assert(first_mismatch.size() == f.num_outputs * f.num_inputs);
 
-/* Print all (remaining) functions with the desired properties to std::cout.
- * Note that the 'properties' vector will not be changed, but its elements.
- * Also prints some statistics to std::cerr. */
-void print_remaining(function& f, std::vector<analyzer*>& properties) {
-    boost::io::ios_width_saver butler_width(std::cerr);
-    std::cerr << "Searching for function with " << properties.size()
-            << " properties:";
-    std::cerr << std::endl;
-    for (analyzer* a : properties) {
-        std::cerr << a->get_name();
-        if (DEBUG_PRINT) {
-            std::cerr << '\t';
-        } else {
-            std::cerr << std::endl;
+        // Partially unwind state
+        for (myint out_pin = 0; out_pin < f.num_outputs; ++out_pin) {
+            for (myint in_pin = 0; in_pin < f.num_inputs; ++in_pin) {
+                myint& first = first_mismatch[out_pin * f.num_inputs + in_pin];
+                if (first != f.end_input && first >= first_changed) {
+                    first = f.end_input;
+                    copying[in_pin] |= pin2mask(out_pin);
+                    ++num_copying;
+                }
+            }
         }
+        if (num_copying == 0) {
+            return bit_address(f);
+        }
+
+        // Wind state forward
+        for (myint i = first_changed; i < f.end_input; ++i) {
+            const myint output = f.image[i];
+            for (myint in_pin = 0; in_pin < f.num_inputs; ++in_pin) {
+                // What 'output' would be if all output pins copied 'in_pin':
+                const myint copy = (i & pin2mask(in_pin)) ? f.end_output - 1 : 0;
+                myint mismatch = (output ^ copy) & copying[in_pin];
+                while (mismatch) {
+                    const myint out_pin = static_cast<myint>(
+                            __builtin_ctz(mismatch));
+                    mismatch &= mismatch - 1;
+                    first_mismatch[out_pin * f.num_inputs + in_pin] = i;
+                    copying[in_pin] &= ~pin2mask(out_pin);
+                    --num_copying;
+                }
+            }
+            if (num_copying == 0) {
+                return bit_address(f);
+            }
+        }
+
+        /* Some output pin copies an input pin.  Pick the most significant
+         * one, as that allows for the biggest jump. */
+        myint copies = 0;
+        for (const myint mask : copying) {
+            copies |= mask;
+        }
+        assert(copies != 0);
+        assert(f.end_input > 0); // already in f's constructor
+        const myint top = static_cast<myint>(
+                sizeof(myint) * 8 - 1 - __builtin_clz(copies));
+        return bit_address(f.end_input - 1, top);
     }
-    if (DEBUG_PRINT) {
-        std::cerr << std::endl;
+
+    virtual const std::string& get_name() const {
+        static const std::string name = "no_copy";
+        return name;
     }
-    size_t steps = 0;
-    myint display_watchdog = 0;
-    myint fns = 0;
-    if (output_ordered::can_fit(f.num_outputs, f.end_input)) {
-        myint last_change = 0;
-        do {
-            if (DEBUG_PRINT) {
-                std::cerr << "#? " << f << std::endl;
-            }
-            ++display_watchdog;
-            ++steps;
-            bit_address next_change(f);
 
-            for (analyzer* a : properties) {
-                const bit_address proposed = a->analyze(f, last_change);
-                if (DEBUG_PRINT) {
-                    std::cerr << proposed << '\t';
-                }
-                next_change.assign_min(proposed);
+    virtual void save(std::ostream& out) const {
+        out << num_copying;
+        for (const myint first : first_mismatch) {
+            out << ' ' << first;
+        }
+    }
+
+    virtual void load(std::istream& in, const function_t& f) {
+        in >> num_copying;
+        myint count = 0;
+        std::fill(copying.begin(), copying.end(), 0);
+        for (size_t i = 0; i < first_mismatch.size(); ++i) {
+            myint& first = first_mismatch[i];
+            in >> first;
+            if (first > f.end_input) {
+                throw std::runtime_error("no_copy: pattern out of range");
             }
-            if (DEBUG_PRINT) {
-                std::cerr << std::endl;
-            }
-            if (next_change.input_pattern == f.end_input) {
-                // Yay!
-                std::cout << "=> " << f << std::endl;
-                ++fns;
-                next_change.input_pattern = f.end_input - 1;
-                next_change.bit = 0;
-            }
-            if (display_watchdog >= DEBUG_PRINT_STEP) {
-                std::cerr << "#_ " << f << std::endl;
-                std::cerr << "#_ " << fns << " fns in " << steps << " steps."
-                        << std::endl;
-                display_watchdog -= DEBUG_PRINT_STEP;
-            }
-            last_change = f.advance(next_change);
-        } while (last_change < f.end_input);
-    } else {
-        std::cerr << "Impossibly many output pins."
-                "  Pruning whole search right away." << std::endl;
+            if (first == f.end_input) {
+                ++count;
+                copying[i % f.num_inputs] |= pin2mask(
+                        static_cast<myint>(i / f.num_inputs));
+            }
+        }
+        if (!in || count != num_copying) {
+            throw std::runtime_error("no_copy: inconsistent state");
+        }
     }
-    std::cerr << std::setw(0) << "Done searching.  Found "
-            << fns << " fns in " << steps << " steps." << std::endl;
-}
 
+private:
+    /* For each output pin and input pin (in that order), on which
+     * input-pattern did the output pin first differ from the input pin? */
+    std::vector<myint> first_mismatch;
+    // For each input pin, the mask of output pins that still copy it.
+    std::vector<myint> copying;
+    // How many pairs are still copying?
+    myint num_copying;
+};
 
-/* ----- Calling it ----- */
+typedef basic_no_copies<function> no_copies;
 
-int main(int argc, char **argv) {
-    myint num_inputs;
-    myint num_outputs;
-    try {
-        num_inputs = (argc > 1) ? parse_arg(argv[1]) : 3;
-        num_outputs = (argc > 2) ? parse_arg(argv[2]) : 3;
-    } catch (const std::invalid_argument& ia) {
-        std::cerr << "Arguments are non-numeric." << std::endl;
-        std::cerr << "Usage: " << argv[0] << " [<num_inputs> [<num_outputs>]]"
-                << std::endl;
-        return 1;
-    } catch (const std::out_of_range& ia) {
-        std::cerr << "Arguments are too big; only [0, " << MAX_BITS
-                << "] is supported!" << std::endl;
-        std::cerr << "Usage: " << argv[0] << " [<num_inputs> [<num_outputs>]]"
-                << std::endl;
-        return 1;
+
+/* ----- Static pipeline ----- */
+/* The list of analyzers in 'make_properties' costs a virtual call per
+ * analyzer and step, and the compiler can't inline anything across those.
+ * A 'pipeline' chains a fixed list of analyzers at compile time instead, and
+ * looks like a single analyzer from the outside.  So the list is still there
+ * for experimenting, and this is for running them (see '--pipeline').
+ *
+ * Each stage must be constructible from the function.  The states are saved
+ * one after the other, which works out as long as each of them is just a
+ * bunch of whitespace-separated numbers (which they are). */
+
+template <typename... stages>
+struct stage_list;
+
+template <>
+struct stage_list<> {
+    stage_list(const function&) {
     }
 
-    std::cerr << "n_in = " << num_inputs << ", n_out = " << num_outputs
-            << std::endl;
+    void analyze(const function&, const myint, bit_address&) {
+    }
+
+    std::string names() const {
+        return "";
+    }
+
+    void save(std::ostream&) const {
+    }
+
+    void load(std::istream&, const function&) {
+    }
+};
+
+template <typename first_t, typename... rest_t>
+struct stage_list<first_t, rest_t...> {
+    stage_list(const function& f) :
+            first(f), rest(f) {
+    }
+
+    /* Note the qualified calls: they are not virtual, and can be inlined. */
+    void analyze(const function& f, const myint first_changed,
+            bit_address& verdict) {
+        verdict.assign_min(first.first_t::analyze(f, first_changed));
+        rest.analyze(f, first_changed, verdict);
+    }
+
+    std::string names() const {
+        const std::string rest_names = rest.names();
+        return first.first_t::get_name()
+                + (rest_names.empty() ? "" : ",") + rest_names;
+    }
+
+    void save(std::ostream& out) const {
+        first.first_t::save(out);
+        out << ' ';
+        rest.save(out);
+    }
+
+    void load(std::istream& in, const function& f) {
+        first.first_t::load(in, f);
+        rest.load(in, f);
+    }
+
+    first_t first;
+    stage_list<rest_t...> rest;
+};
+
+template <typename... stages>
+class pipeline: public analyzer {
+public:
+    pipeline(const function& f) :
+            list(f), name("pipeline(" + list.names() + ")") {
+    }
+
+    virtual ~pipeline() = default;
+
+    virtual bit_address analyze(const function& f, const myint first_changed) {
+        bit_address verdict(f);
+        list.analyze(f, first_changed, verdict);
+        return verdict;
+    }
+
+    virtual const std::string& get_name() const {
+        return name;
+    }
+
+    virtual void save(std::ostream& out) const {
+        list.save(out);
+    }
+
+    virtual void load(std::istream& in, const function& f) {
+        list.load(in, f);
+    }
+
+private:
+    stage_list<stages...> list;
+    const std::string name;
+};
+
+/* Same order as 'make_properties' uses. */
+typedef pipeline<output_ordered, metastability_containing, input_relevance>
+        separate_pipeline;
+
+
+/* ----- Fused analyzer ----- */
+/* Does the work of 'output_ordered', 'metastability_containing' and
+ * 'input_relevance' (in that order) in a single loop over the image, and
+ * returns exactly what the minimum of their verdicts would be.  This saves
+ * two virtual calls and two scans of the image per step.  The separate
+ * analyzers are still better to read and to experiment with, though, so they
+ * stay around as a reference (see '--separate').
+ *
+ * Note that this stops scanning at the first complaint, whereas the separate
+ * analyzers might have recorded some state beyond that place.  This doesn't
+ * matter: the next step changes the complaining place (or a more significant
+ * one), so all that state would be unwound anyway.
+ *
+ * The dimensions of the function are either known at run time
+ * ('dynamic_dims'), or at compile time ('static_dims', see below).  The latter
+ * lets the compiler unroll the loops over input pins, and turn all the
+ * 'pin2mask' and 'can_fit' business into constants. */
+
+struct dynamic_dims {
+    template <typename function_t>
+    dynamic_dims(const function_t& f) :
+            n_in(f.num_inputs), n_out(f.num_outputs), end_in(f.end_input) {
+    }
+
+    myint num_inputs() const {
+        return n_in;
+    }
+
+    myint num_outputs() const {
+        return n_out;
+    }
+
+    myint end_input() const {
+        return end_in;
+    }
+
+private:
+    const myint n_in;
+    const myint n_out;
+    const myint end_in;
+};
+
+template <typename dims, typename function_t>
+class basic_fused_analyzer: public basic_analyzer<function_t> {
+public:
+    basic_fused_analyzer(const function_t& f) :
+            d(f), first_relevant(f.num_inputs, f.end_input) {
+        assert(f.num_inputs == d.num_inputs());
+        assert(f.num_outputs == d.num_outputs());
+        assert(f.num_outputs > 0);
+        first_ones.reserve(f.num_outputs);
+    }
+
+    virtual ~basic_fused_analyzer() = default;
+
+    virtual bit_address analyze(const function_t& f,
+            const myint first_changed) {
+        assert(first_relevant.size() == d.num_inputs());
+        assert(first_ones.size() <= d.num_outputs());
+        // See output_ordered::analyze.
+        assert(output_ordered::can_fit(d.num_outputs(), d.end_input()));
+
+        // Partially unwind state
+        for (myint in_pin = 0;
+                in_pin < d.num_inputs() && relevant_inputs > 0; ++in_pin) {
+            if (first_relevant[in_pin] != d.end_input()
+                    && first_relevant[in_pin] >= first_changed) {
+                --relevant_inputs;
+                first_relevant[in_pin] = d.end_input();
+            }
+        }
+        while (!first_ones.empty() && first_ones.back() >= first_changed) {
+            first_ones.pop_back();
+        }
+
+        // Wind state forward
+        for (myint i = first_changed; i < d.end_input(); ++i) {
+            const myint output = f.image[i];
+            /* Smallest bit that needs to change at place 'i' (plus one),
+             * or 0 if place 'i' is fine. */
+            myint bit_plus_one = 0;
+
+            // output_ordered
+            const myint out_pin = static_cast<myint>(first_ones.size());
+            if (out_pin < d.num_outputs()) {
+                if (output & ~(pin2mask(out_pin + 1) - 1)) {
+                    /* A "naughty" bit.  This is more significant than
+                     * anything at place 'i'. */
+                    assert(i > 0);
+                    return bit_address(i - 1, 0);
+                }
+                if (output & pin2mask(out_pin)) {
+                    assert(first_ones.empty() || first_ones.back() < i);
+                    first_ones.push_back(i);
+                } else if (!output_ordered::can_fit(
+                        d.num_outputs() - first_ones.size(),
+                        d.end_input() - (i + 1))) {
+                    // Missed opportunity.
+                    bit_plus_one = out_pin + 1;
+                }
+            }
+
+            // metastability_containing, and input_relevance
+            myint max_tz_plus_one = 0;
+            for (myint j = d.num_inputs(); j > 0; --j) {
+                const myint in_pin = j - 1;
+                if (!(i & pin2mask(in_pin))) {
+                    continue;
+                }
+                const myint opposite = f.image[i & ~pin2mask(in_pin)];
+                const myint change = output ^ opposite;
+                if (!metastability_containing::is_pot_or_zero(change)) {
+                    max_tz_plus_one = std::max(max_tz_plus_one,
+                            myint(__builtin_ctz(change) + 1));
+                }
+                if (change && first_relevant[in_pin] == d.end_input()) {
+                    first_relevant[in_pin] = i;
+                    ++relevant_inputs;
+                }
+            }
+            if (max_tz_plus_one && (!bit_plus_one
+                    || max_tz_plus_one < bit_plus_one)) {
+                bit_plus_one = max_tz_plus_one;
+            }
+
+            if (bit_plus_one) {
+                if (i == d.end_input() - 1
+                        && relevant_inputs < d.num_inputs()) {
+                    // Tie with input_relevance's complaint, see below.
+                    bit_plus_one = 1;
+                }
+                return bit_address(i, bit_plus_one - 1);
+            }
+        }
 
-    function f = function(num_inputs, num_outputs);
+        /* All places are fine, and 'output_ordered' can't possibly be
+         * unsatisfied by now.  So it's all up to 'input_relevance'. */
+        assert(first_ones.size() == d.num_outputs());
+        if (relevant_inputs < d.num_inputs()) {
+            return bit_address(d.end_input() - 1, 0); // smallest increment
+        }
+        return bit_address(f);
+    }
 
-    /* HERE BE DRAGONS!  The analyzers are not really as independent as they
-     * may seem.  For instance, 'output_ordered' may sometimes (and
-     * inconsistently) enforce metastability-containment.  Thus, if you remove
-     * 'metastability_containing' from the list but leave 'output_ordered', you
-     * may be surprised by some/all functions being skipped. */
-    metastability_containing p_msc;
-    input_relevance p_ir(f);
-    output_ordered p_ord(f);
+    /* Same for all dimensions, so checkpoints don't care either. */
+    virtual const std::string& get_name() const {
+        static const std::string name = "fused(out_ord,is_msc,in_rel)";
+        return name;
+    }
 
-    std::vector<analyzer*> properties;
-    properties.push_back(&p_ord);
-    properties.push_back(&p_msc);
-    properties.push_back(&p_ir);
+    /* Same format as 'input_relevance' and 'output_ordered', one after the
+     * other. */
+    virtual void save(std::ostream& out) const {
+        out << relevant_inputs;
+        for (const myint first : first_relevant) {
+            out << ' ' << first;
+        }
+        out << ' ' << first_ones.size();
+        for (const myint first : first_ones) {
+            out << ' ' << first;
+        }
+    }
 
-    print_remaining(f, properties);
+    virtual void load(std::istream& in, const function_t& f) {
+        myint count = 0;
+        in >> relevant_inputs;
+        for (myint& first : first_relevant) {
+            in >> first;
+            if (first > f.end_input) {
+                throw std::runtime_error("fused: pattern out of range");
+            }
+            count += (first != f.end_input);
+        }
+        size_t size = 0;
+        in >> size;
+        if (!in || count != relevant_inputs || size > f.num_outputs) {
+            throw std::runtime_error("fused: inconsistent state");
+        }
+        first_ones.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            in >> first_ones[i];
+            if (first_ones[i] >= f.end_input
+                    || (i > 0 && first_ones[i - 1] >= first_ones[i])) {
+                throw std::runtime_error("fused: first ones not ordered");
+            }
+        }
+        if (!in) {
+            throw std::runtime_error("fused: truncated state");
+        }
+    }
+
+private:
+    const dims d;
+    // See input_relevance
+    std::vector<myint> first_relevant;
+    myint relevant_inputs = 0;
+    // See output_ordered
+    std::vector<myint> first_ones;
+};
+
+typedef basic_fused_analyzer<dynamic_dims, function> fused_analyzer;
+
+
+/* ----- Compile-time dimensions ----- */
+/* Instantiate 'basic_fused_analyzer' for every combination of dimensions up
+ * to these bounds.  Off by default:  each combination is another copy of the
+ * analyzer, and all of 5 x 16 take a plain 'make' from seconds to more than
+ * a minute, for up to 30% per step.  So for a long run, build with e.g.
+ *     -DMCF_FIXED_MAX_INPUTS=5 -DMCF_FIXED_MAX_OUTPUTS=13
+ * 'output_ordered::can_fit' rules out more than 2^(#in - 1) outputs anyway. */
+#ifndef MCF_FIXED_MAX_INPUTS
+#define MCF_FIXED_MAX_INPUTS 0
+#endif
+#ifndef MCF_FIXED_MAX_OUTPUTS
+#define MCF_FIXED_MAX_OUTPUTS 0
+#endif
+static_assert(MCF_FIXED_MAX_INPUTS <= MAX_BITS, "Bad MCF_FIXED_MAX_INPUTS");
+static_assert(MCF_FIXED_MAX_OUTPUTS <= MAX_BITS, "Bad MCF_FIXED_MAX_OUTPUTS");
+
+template <myint N_IN, myint N_OUT>
+struct static_dims {
+    template <typename function_t>
+    static_dims(const function_t&) {
+    }
+
+    static constexpr myint num_inputs() {
+        return N_IN;
+    }
+
+    static constexpr myint num_outputs() {
+        return N_OUT;
+    }
+
+    static constexpr myint end_input() {
+        return static_cast<myint>(1) << N_IN;
+    }
+};
+
+/* Find the instantiation for 'f', by counting down N_OUT, and then N_IN.
+ * Each N_OUT is only instantiated with the smallest fitting image storage
+ * (see 'place_for'), which is what 'run_search' picks anyway.
+ * Returns nullptr if 'f' is too big. */
+template <myint N_IN, myint N_OUT>
+struct fixed_outputs {
+    typedef basic_function<typename place_for<N_OUT>::type> packed_function;
+
+    static basic_analyzer<packed_function>* make(const packed_function& f) {
+        if (f.num_outputs == N_OUT) {
+            return new basic_fused_analyzer<static_dims<N_IN, N_OUT>,
+                    packed_function>(f);
+        }
+        return fixed_outputs<N_IN, N_OUT - 1>::make(f);
+    }
+
+    template <typename function_t>
+    static basic_analyzer<function_t>* make(const function_t& f) {
+        return fixed_outputs<N_IN, N_OUT - 1>::make(f);
+    }
+};
+
+template <myint N_IN>
+struct fixed_outputs<N_IN, 0> {
+    template <typename function_t>
+    static basic_analyzer<function_t>* make(const function_t&) {
+        return nullptr;
+    }
+};
+
+template <myint N_IN>
+struct fixed_inputs {
+    template <typename function_t>
+    static basic_analyzer<function_t>* make(const function_t& f) {
+        if (f.num_inputs == N_IN) {
+            return fixed_outputs<N_IN, MCF_FIXED_MAX_OUTPUTS>::make(f);
+        }
+        return fixed_inputs<N_IN - 1>::make(f);
+    }
+};
+
+template <>
+struct fixed_inputs<0> {
+    template <typename function_t>
+    static basic_analyzer<function_t>* make(const function_t&) {
+        return nullptr;
+    }
+};
+
+/* A fused analyzer with compile-time dimensions, if there is one for 'f',
+ * or with run-time dimensions otherwise. */
+template <typename function_t>
+basic_analyzer<function_t>* make_fused_analyzer(const function_t& f) {
+    basic_analyzer<function_t>* fixed =
+            fixed_inputs<MCF_FIXED_MAX_INPUTS>::make(f);
+    return fixed ? fixed
+            : new basic_fused_analyzer<dynamic_dims, function_t>(f);
+}
+
+
+/* ----- Symmetries ----- */
+/* Permuting the input pins of a function doesn't change anything interesting
+ * about it:  it's still metastability-containing, and all pins stay relevant.
+ * Neither does flipping some input pins (i.e., translating the hypercube),
+ * as neighbouring input patterns stay neighbours.  That breaks 'f(0) == 0',
+ * but XOR-ing all outputs with the new 'f(0)' repairs it, and doesn't change
+ * which outputs differ between neighbours either.
+ * So, optionally, keep only one function of each such class.
+ *
+ * Note that 'output_ordered' already picks one function of each class under
+ * output permutations.  Permuting or flipping the inputs of such a function
+ * usually breaks that order, so it has to be restored before comparing.
+ * Together, this picks the lexicographically smallest (read: first visited)
+ * function of each class under input permutations and/or flips, and output
+ * permutations. */
+
+/* Up to 7! * 2^7 places of permutation tables, which is about 2.5 MB.
+ * Don't even think about running 8 inputs. */
+#define MAX_PERMUTED_INPUTS 7
+// Up to 2^10 * 2^10 places of tables, which is 4 MB.
+#define MAX_FLIPPED_INPUTS 10
+// Up to 6! * 2^6 * 2^6 places of tables, which is about 12 MB.
+#define MAX_PERMUTED_FLIPPED_INPUTS 6
+
+/* Where the permutation 'pins' (input pin 'i' goes to 'pins[i]') followed by
+ * flipping the input pins in 'flip' maps each pattern. */
+std::vector<myint> make_transform(const std::vector<myint>& pins,
+        const myint flip, const myint end_input) {
+    std::vector<myint> table(end_input);
+    for (myint x = 0; x < end_input; ++x) {
+        for (myint pin = 0; pin < pins.size(); ++pin) {
+            if (x & pin2mask(pin)) {
+                table[x] |= pin2mask(pins[pin]);
+            }
+        }
+        table[x] ^= flip;
+    }
+    return table;
+}
+
+/* Compares a transformed function (see above) to the original. */
+class transform_comparator {
+public:
+    explicit transform_comparator(const myint num_outputs) :
+            labels(num_outputs) {
+    }
+
+    /* Compares the transformed, renormalized and reordered 'f' to 'f'.
+     * Returns a negative number if it is smaller, a positive one if it is
+     * larger, and zero if they are the same.  In the first two cases, also
+     * sets 'blame'. */
+    template <typename function_t>
+    int compare(const function_t& f, const std::vector<myint>& transform,
+            myint& blame) {
+        // Output pins of 'g' get labels in the order in which they first go 1.
+        std::fill(labels.begin(), labels.end(), 0);
+        myint num_labels = 0;
+        // The new 'f(0)', which becomes 0 again.
+        blame = transform[0];
+        const myint offset = f.image[blame];
+        for (myint x = 0; x < f.end_input; ++x) {
+            const myint y = transform[x];
+            blame = std::max(blame, std::max(x, y));
+            const myint raw = f.image[y] ^ offset;
+            myint reordered = 0;
+            for (myint out_pin = 0; out_pin < f.num_outputs; ++out_pin) {
+                if (!(raw & pin2mask(out_pin))) {
+                    continue;
+                }
+                if (!labels[out_pin]) {
+                    labels[out_pin] = pin2mask(num_labels++);
+                }
+                reordered |= labels[out_pin];
+            }
+            const myint original = f.image[x];
+            if (reordered != original) {
+                return reordered < original ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+private:
+    // Scratch space.
+    std::vector<myint> labels;
+};
+
+/* Check that no permutation and/or flip of input pins (followed by restoring
+ * 'f(0) == 0' and the order of output pins) yields a lexicographically
+ * smaller function.
+ *
+ * The image of 'f' permuted by 'pi' and flipped by 't' is
+ * 'g[x] = f[pi(x) ^ t] ^ f[t]'.  Comparing that to 'f' place by place, the
+ * first difference at place 'x' depends only on the places of 'f' up to 'x',
+ * place 't', and all 'pi(y) ^ t' for 'y <= x'.  The last of these places is
+ * the one to blame, whatever the verdict. */
+template <typename function_t>
+class basic_input_ordered: public basic_analyzer<function_t> {
+public:
+    basic_input_ordered(const function_t& f, const bool permute = true,
+            const bool flip = false) :
+            name(permute ? (flip ? "in_sym" : "in_ord") : "in_flip"),
+            comparator(f.num_outputs) {
+        assert(permute || flip);
+        assert(f.num_inputs <= (!flip ? MAX_PERMUTED_INPUTS
+                : !permute ? MAX_FLIPPED_INPUTS
+                : MAX_PERMUTED_FLIPPED_INPUTS));
+        std::vector<myint> pins(f.num_inputs);
+        for (myint pin = 0; pin < f.num_inputs; ++pin) {
+            pins[pin] = pin;
+        }
+        do {
+            for (myint t = 0; t < (flip ? f.end_input : 1); ++t) {
+                // Skip the identity.
+                if (t != 0 || !std::is_sorted(pins.begin(), pins.end())) {
+                    transforms.push_back(make_transform(pins, t, f.end_input));
+                }
+            }
+        } while (permute && std::next_permutation(pins.begin(), pins.end()));
+        fine_through.resize(transforms.size(), f.end_input);
+    }
+
+    virtual ~basic_input_ordered() = default;
+
+    virtual bit_address analyze(const function_t& f,
+            const myint first_changed) {
+        for (size_t p = 0; p < transforms.size(); ++p) {
+            // Nothing that was to blame has changed since last time?
+            if (first_changed > fine_through[p]) {
+                continue;
+            }
+            myint blame;
+            const int cmp = comparator.compare(f, transforms[p], blame);
+            if (cmp < 0) {
+                // Don't look at the rest, but don't trust them later either.
+                for (size_t q = p; q < transforms.size(); ++q) {
+                    if (first_changed <= fine_through[q]) {
+                        fine_through[q] = f.end_input;
+                    }
+                }
+                assert(blame > 0);
+                return bit_address(blame, 0);
+            }
+            fine_through[p] = cmp > 0 ? blame : f.end_input;
+        }
+        return bit_address(f);
+    }
+
+    virtual const std::string& get_name() const {
+        return name;
+    }
+
+    /* Note that 'fine_through' only caches verdicts, and starts out empty
+     * anyway.  So there's nothing to save. */
+
+private:
+    const std::string name;
+    /* For each permutation and/or flip (except the identity), where it maps
+     * each pattern. */
+    std::vector<std::vector<myint>> transforms;
+    /* For each transform, up to which place the image must stay the same
+     * for the transformed function to stay bigger.  'end_input' if
+     * unknown. */
+    std::vector<myint> fine_through;
+    transform_comparator comparator;
+};
+
+typedef basic_input_ordered<function> input_ordered;
+
+/* Check that a single transform maps the function to itself, i.e., that it
+ * is a fixed point.  Any difference at all rejects, no matter in which
+ * direction.  Only used for counting classes, see 'print_classes'.
+ *
+ * 'compare' can't say anything before it has seen place 't' (the new
+ * 'f(0)'), which may well be the very last one.  However, the output
+ * permutation and the XOR with 'f(t)' don't change how many output pins
+ * differ between two patterns.  So for a fixed point, 'f(x) ^ f(y)' and
+ * 'f(T(x)) ^ f(T(y))' always have the same number of ones, which can be
+ * checked as soon as all four places are there. */
+template <typename function_t>
+class basic_fixed_by: public basic_analyzer<function_t> {
+public:
+    basic_fixed_by(const function_t& f, const std::vector<myint>& transform) :
+            transform(transform), order(f.end_input),
+            comparator(f.num_outputs) {
+        for (myint x = 0; x < f.end_input; ++x) {
+            order[x] = x;
+        }
+        // By the last place that each pattern needs.
+        std::stable_sort(order.begin(), order.end(),
+                [&transform](const myint x, const myint y) {
+                    return std::max(x, transform[x])
+                            < std::max(y, transform[y]);
+                });
+    }
+
+    virtual ~basic_fixed_by() = default;
+
+    virtual bit_address analyze(const function_t& f,
+            const myint first_changed) {
+        /* Pairs that need only places before 'first_changed' were fine last
+         * time, so start at the first pattern that needs a changed one. */
+        for (myint i = 1; i < f.end_input; ++i) {
+            const myint x = order[i];
+            const myint last = std::max(x, transform[x]);
+            if (last < first_changed) {
+                continue;
+            }
+            for (myint j = 0; j < i; ++j) {
+                const myint y = order[j];
+                if (__builtin_popcount(f.image[x] ^ f.image[y])
+                        != __builtin_popcount(f.image[transform[x]]
+                                ^ f.image[transform[y]])) {
+                    return bit_address(last, 0);
+                }
+            }
+        }
+        myint blame;
+        if (comparator.compare(f, transform, blame) != 0) {
+            assert(blame > 0);
+            return bit_address(blame, 0);
+        }
+        return bit_address(f);
+    }
+
+    virtual const std::string& get_name() const {
+        static const std::string name = "fixed";
+        return name;
+    }
+
+private:
+    const std::vector<myint> transform;
+    // All patterns, by 'max(x, transform[x])'.
+    std::vector<myint> order;
+    transform_comparator comparator;
+};
+
+
+/* ----- Bit-sliced images ----- */
+/* The image, transposed: for each output pin, one bitmask over all input
+ * patterns.  Then "is this pin ever on", "does this pin ever differ across
+ * that input pin" and neighbour comparisons work on 64 places at once,
+ * using XOR and shifts.
+ * The slices are kept next to the ordinary image, which stays the master
+ * copy: printing, checkpoints and the other analyzers keep reading that.
+ * Thus, anything that changes the image has to go through 'advance',
+ * 'set_prefix' or 'set_image'. */
+
+typedef std::uint64_t slice_word;
+
+const static myint SLICE_BITS = 64;
+const static myint SLICE_SHIFT = 6;
+
+/* For input pin 'k' below SLICE_SHIFT: which places of a word have that pin
+ * set, i.e., have a neighbour 2^k places before them. */
+const static slice_word SLICE_UPPER[SLICE_SHIFT] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
+
+class sliced_function: public function {
+public:
+    sliced_function(const myint num_inputs, const myint num_outputs) :
+            function(num_inputs, num_outputs),
+            words((end_input + SLICE_BITS - 1) / SLICE_BITS),
+            slices(num_outputs * words) {
+    }
+
+    /* Same as function::advance.  Afterwards, all places after the returned
+     * one are 0, so only that one needs to be written. */
+    myint advance(const bit_address at) {
+        const myint changed = function::advance(at);
+        if (changed >= end_input) {
+            clear_from(1);
+        } else {
+            clear_from(changed);
+            write_place(changed);
+        }
+        return changed;
+    }
+
+    // Same as function::advance_admissible, see above.
+    myint advance_admissible(const bit_address at) {
+        const myint changed = function::advance_admissible(at);
+        if (changed >= end_input) {
+            clear_from(1);
+        } else {
+            clear_from(changed);
+            write_place(changed);
+        }
+        return changed;
+    }
+
+    void set_prefix(const myint depth, const prefix_t prefix) {
+        function::set_prefix(depth, prefix);
+        rebuild();
+    }
+
+    template <typename iterator_t>
+    void set_image(const iterator_t begin, const iterator_t end) {
+        function::set_image(begin, end);
+        rebuild();
+    }
+
+    /* Word 'w' of the slice of 'out_pin'. */
+    slice_word slice(const myint out_pin, const myint w) const {
+        return slices[out_pin * words + w];
+    }
+
+    /* Places in word 'w' where 'out_pin' differs from the neighbour across
+     * 'in_pin', i.e., the place with 'in_pin' cleared.  Only places with
+     * 'in_pin' set are considered, so each pair of neighbours counts once. */
+    slice_word flips(const myint out_pin, const myint in_pin,
+            const myint w) const {
+        const slice_word here = slice(out_pin, w);
+        if (in_pin < SLICE_SHIFT) {
+            return (here ^ (here << pin2mask(in_pin))) & SLICE_UPPER[in_pin];
+        }
+        const myint distance = pin2mask(in_pin - SLICE_SHIFT);
+        if (!(w & distance)) {
+            return 0;
+        }
+        return here ^ slice(out_pin, w - distance);
+    }
+
+    /* First place where 'out_pin' is on, or 'end_input' if there is none. */
+    myint first_one(const myint out_pin) const {
+        for (myint w = 0; w < words; ++w) {
+            const slice_word here = slice(out_pin, w);
+            if (here) {
+                return w * SLICE_BITS + __builtin_ctzll(here);
+            }
+        }
+        return end_input;
+    }
+
+    const myint words;
+
+private:
+    void clear_from(const myint place) {
+        const myint first_word = place / SLICE_BITS;
+        const slice_word keep = (slice_word(1) << (place % SLICE_BITS)) - 1;
+        for (myint out_pin = 0; out_pin < num_outputs; ++out_pin) {
+            slice_word* s = &slices[out_pin * words];
+            s[first_word] &= keep;
+            std::fill(s + first_word + 1, s + words, 0);
+        }
+    }
+
+    void write_place(const myint place) {
+        const myint w = place / SLICE_BITS;
+        const slice_word bit = slice_word(1) << (place % SLICE_BITS);
+        for (myint out_pin = 0; out_pin < num_outputs; ++out_pin) {
+            if (image[place] & pin2mask(out_pin)) {
+                slices[out_pin * words + w] |= bit;
+            }
+        }
+    }
+
+    void rebuild() {
+        std::fill(slices.begin(), slices.end(), 0);
+        for (myint i = 0; i < end_input; ++i) {
+            write_place(i);
+        }
+    }
+
+    std::vector<slice_word> slices;
+};
+
+typedef basic_analyzer<sliced_function> sliced_analyzer;
+
+/* The bit-sliced counterpart of 'output_ordered'.  Being stateless, it
+ * computes all first ones and then replays what 'output_ordered' would have
+ * done, event by event.  Same verdicts. */
+class sliced_output_ordered: public sliced_analyzer {
+public:
+    sliced_output_ordered(const sliced_function& f) :
+            first_ones(f.num_outputs), later_ones(f.num_outputs) {
+    }
+
+    virtual ~sliced_output_ordered() = default;
+
+    virtual bit_address analyze(const sliced_function& f, const myint) {
+        const myint n = f.num_outputs;
+        // 'later_ones[c]' is the first place where a pin above 'c' is on.
+        myint later = f.end_input;
+        for (myint c = n; c > 0; --c) {
+            first_ones[c - 1] = f.first_one(c - 1);
+            later_ones[c - 1] = later;
+            later = std::min(later, first_ones[c - 1]);
+        }
+        settled = f.end_input;
+        for (myint c = 0; c < n; ++c) {
+            /* From this place on, there's not enough runway left to fit
+             * the remaining first ones, see 'output_ordered::can_fit'.
+             * That's never before the previous first one. */
+            const myint missed = f.end_input + 1 - 2 * (n - c);
+            const myint naughty = later_ones[c];
+            if (naughty <= first_ones[c] && naughty <= missed) {
+                // A too high pin came first.  Place 0 is never naughty.
+                return bit_address(naughty - 1, 0);
+            }
+            if (missed < first_ones[c]) {
+                return bit_address(missed, c);
+            }
+        }
+        settled = first_ones[n - 1] + 1;
+        return bit_address(f);
+    }
+
+    virtual const std::string& get_name() const {
+        static const std::string name = "sliced_out_ord";
+        return name;
+    }
+
+    virtual myint settled_before(const sliced_function&) const {
+        return settled;
+    }
+
+private:
+    // Scratch space, to save allocations.
+    std::vector<myint> first_ones;
+    std::vector<myint> later_ones;
+    myint settled = 0;
+};
+
+/* The bit-sliced counterpart of 'metastability_containing'.  For each input
+ * pin, counts how many output pins flip across it (saturating at two), for
+ * 64 places at once.  The bit to change is then found the scalar way, which
+ * also guarantees the same verdicts. */
+class sliced_metastability_containing: public sliced_analyzer {
+public:
+    sliced_metastability_containing(const sliced_function&) {
+    }
+
+    virtual ~sliced_metastability_containing() = default;
+
+    virtual bit_address analyze(const sliced_function& f,
+            const myint first_changed) {
+        myint w = first_changed / SLICE_BITS;
+        slice_word bad = bad_places(f, w)
+                & (~slice_word(0) << (first_changed % SLICE_BITS));
+        while (!bad && ++w < f.words) {
+            bad = bad_places(f, w);
+        }
+        if (!bad) {
+            return bit_address(f);
+        }
+        const myint i = w * SLICE_BITS + __builtin_ctzll(bad);
+        return bit_address(i, metastability_containing::bad_bit_plus_one(
+                f.image.data(), f.num_inputs, i) - 1);
+    }
+
+    virtual const std::string& get_name() const {
+        static const std::string name = "sliced_is_msc";
+        return name;
+    }
+
+private:
+    static slice_word bad_places(const sliced_function& f, const myint w) {
+        slice_word bad = 0;
+        for (myint in_pin = 0; in_pin < f.num_inputs; ++in_pin) {
+            slice_word once = 0;
+            slice_word twice = 0;
+            for (myint out_pin = 0; out_pin < f.num_outputs; ++out_pin) {
+                const slice_word flips = f.flips(out_pin, in_pin, w);
+                twice |= once & flips;
+                once |= flips;
+            }
+            bad |= twice;
+        }
+        return bad;
+    }
+};
+
+/* The bit-sliced counterpart of 'input_relevance'.  Stateless: an input pin
+ * is relevant iff any output pin flips across it, anywhere. */
+class sliced_input_relevance: public sliced_analyzer {
+public:
+    sliced_input_relevance(const sliced_function&) {
+    }
+
+    virtual ~sliced_input_relevance() = default;
+
+    virtual bit_address analyze(const sliced_function& f, const myint) {
+        myint last = 0;
+        settled = f.end_input;
+        for (myint in_pin = 0; in_pin < f.num_inputs; ++in_pin) {
+            const myint first = first_relevant(f, in_pin);
+            if (first == f.end_input) {
+                // Same as 'input_relevance': can't say much.
+                return bit_address(f.end_input - 1, 0);
+            }
+            last = std::max(last, first);
+        }
+        settled = last + 1;
+        return bit_address(f);
+    }
+
+    virtual const std::string& get_name() const {
+        static const std::string name = "sliced_in_rel";
+        return name;
+    }
+
+    virtual myint settled_before(const sliced_function&) const {
+        return settled;
+    }
+
+private:
+    static myint first_relevant(const sliced_function& f, const myint in_pin) {
+        for (myint w = 0; w < f.words; ++w) {
+            slice_word flips = 0;
+            for (myint out_pin = 0; out_pin < f.num_outputs; ++out_pin) {
+                flips |= f.flips(out_pin, in_pin, w);
+            }
+            if (flips) {
+                return w * SLICE_BITS + __builtin_ctzll(flips);
+            }
+        }
+        return f.end_input;
+    }
+
+    myint settled = 0;
+};
+
+
+/* ----- Checkpoints ----- */
+/* Everything needed to continue a search bit-exactly, after the process got
+ * killed.  This is written to a plain text file:
+ *     MetaContFn checkpoint 1
+ *     <num_inputs> <num_outputs>
+ *     <steps> <fns> <last_change>
+ *     <image, in hex> (or "done")
+ *     <name of first analyzer> <its state>
+ *     ...
+ * Note that analyzers only care about the function itself, so a checkpoint
+ * with 'last_change == 0' doesn't need the analyzers' states (and the parallel
+ * search writes only those). */
+
+struct checkpoint {
+    myint num_inputs;
+    myint num_outputs;
+    size_t steps;
+    myint fns;
+    myint last_change;
+    /* Next function to be analyzed.  Empty if the search is done.
+     * Always as wide as 'function', no matter how the search stored it. */
+    function::image_t image;
+    // For each analyzer, its name, a space, and its state.
+    std::vector<std::string> states;
+};
+
+template <typename function_t>
+std::vector<std::string> save_states(
+        const basic_properties<function_t>& properties) {
+    std::vector<std::string> states;
+    for (const std::unique_ptr<basic_analyzer<function_t>>& a : properties) {
+        std::ostringstream buf;
+        buf << a->get_name() << ' ';
+        a->save(buf);
+        states.push_back(buf.str());
+    }
+    return states;
+}
+
+template <typename function_t>
+void load_states(basic_properties<function_t>& properties,
+        const std::vector<std::string>& states, const function_t& f) {
+    if (states.size() != properties.size()) {
+        throw std::runtime_error("checkpoint has wrong number of analyzers");
+    }
+    for (size_t i = 0; i < states.size(); ++i) {
+        std::istringstream buf(states[i]);
+        std::string name;
+        buf >> name;
+        if (name != properties[i]->get_name()) {
+            throw std::runtime_error("checkpoint has analyzer " + name
+                    + " instead of " + properties[i]->get_name());
+        }
+        properties[i]->load(buf, f);
+    }
+}
+
+void write_checkpoint(const std::string& filename, const checkpoint& cp) {
+    /* Never leave a half-written checkpoint behind, not even when killed
+     * right now. */
+    const std::string tmp_filename = filename + ".tmp";
+    {
+        std::ofstream out(tmp_filename.c_str());
+        out << "MetaContFn checkpoint 1\n";
+        out << cp.num_inputs << ' ' << cp.num_outputs << '\n';
+        out << cp.steps << ' ' << cp.fns << ' ' << cp.last_change << '\n';
+        if (cp.image.empty()) {
+            out << "done";
+        } else {
+            out << std::hex;
+            for (size_t i = 0; i < cp.image.size(); ++i) {
+                out << (i ? " " : "") << cp.image[i];
+            }
+            out << std::dec;
+        }
+        out << '\n';
+        for (const std::string& state : cp.states) {
+            out << state << '\n';
+        }
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("can't write " + tmp_filename);
+        }
+    }
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        throw std::runtime_error("can't replace " + filename);
+    }
+}
+
+checkpoint read_checkpoint(const std::string& filename) {
+    std::ifstream in(filename.c_str());
+    std::string line;
+    if (!std::getline(in, line) || line != "MetaContFn checkpoint 1") {
+        throw std::runtime_error("not a checkpoint: " + filename);
+    }
+    checkpoint cp;
+    in >> cp.num_inputs >> cp.num_outputs;
+    in >> cp.steps >> cp.fns >> cp.last_change;
+    if (!in || cp.num_inputs < 1 || cp.num_inputs > MAX_BITS
+            || cp.num_outputs < 1 || cp.num_outputs > MAX_BITS) {
+        throw std::runtime_error("bad checkpoint header in " + filename);
+    }
+    std::getline(in, line);
+    std::getline(in, line);
+    if (line != "done") {
+        const function f(cp.num_inputs, cp.num_outputs);
+        std::istringstream buf(line);
+        buf >> std::hex;
+        myint place;
+        while (buf >> place) {
+            if (place >= f.end_output) {
+                throw std::runtime_error("bad image in " + filename);
+            }
+            cp.image.push_back(place);
+        }
+        if (cp.image.size() != f.end_input || cp.image[0] != 0
+                || cp.last_change >= f.end_input) {
+            throw std::runtime_error("bad image in " + filename);
+        }
+    }
+    while (std::getline(in, line)) {
+        cp.states.push_back(line);
+    }
+    return cp;
+}
+
+const static unsigned DEFAULT_CHECKPOINT_INTERVAL = 600;
+
+/* Decides when to write the next checkpoint.  Asking is cheap-ish, but not
+ * free, so don't ask on every step. */
+class checkpointer {
+public:
+    checkpointer(const std::string& filename, const unsigned interval) :
+            filename(filename), interval(interval),
+            next_due(std::chrono::steady_clock::now() + this->interval) {
+    }
+
+    bool enabled() const {
+        return !filename.empty();
+    }
+
+    bool due() const {
+        return enabled() && std::chrono::steady_clock::now() >= next_due;
+    }
+
+    void write(const checkpoint& cp) {
+        // Anything printed so far must not get lost, either.
+        std::cout.flush();
+        write_checkpoint(filename, cp);
+        next_due = std::chrono::steady_clock::now() + interval;
+    }
+
+private:
+    const std::string filename;
+    const std::chrono::seconds interval;
+    std::chrono::steady_clock::time_point next_due;
+};
+
+
+/* ----- Binary output ----- */
+/* Text output is nice to read, but slow to write, and big.  So optionally,
+ * found functions are printed like this instead:
+ *     "MCFb", then one byte each: version (1), num_inputs, num_outputs, and
+ *     bytes per place
+ *     For each function, all places of its image, each little-endian in
+ *     'bytes per place' bytes
+ * As image[0] is always 0, a function never starts with 'M'.  So several
+ * outputs (e.g. before and after '--resume') can simply be concatenated.
+ * '--decode' turns all this back into the usual text. */
+
+const static char BINARY_MAGIC[] = "MCFb";
+const static char BINARY_VERSION = 1;
+const static size_t BINARY_HEADER_SIZE = 8;
+
+myint bytes_per_place(const myint num_outputs) {
+    return (num_outputs + 7) / 8;
+}
+
+void write_binary_header(std::ostream& out, const myint num_inputs,
+        const myint num_outputs) {
+    const char header[BINARY_HEADER_SIZE] = {
+        BINARY_MAGIC[0], BINARY_MAGIC[1], BINARY_MAGIC[2], BINARY_MAGIC[3],
+        BINARY_VERSION, static_cast<char>(num_inputs),
+        static_cast<char>(num_outputs),
+        static_cast<char>(bytes_per_place(num_outputs))
+    };
+    out.write(header, BINARY_HEADER_SIZE);
+}
+
+template <typename function_t>
+void write_binary(std::ostream& out, const function_t& f) {
+    // Skip the sentry business of 'out.put', this happens a lot.
+    std::streambuf& buf = *out.rdbuf();
+    const myint width = bytes_per_place(f.num_outputs);
+    for (const myint place : f.image) {
+        for (myint b = 0; b < width; ++b) {
+            buf.sputc(static_cast<char>(place >> (8 * b)));
+        }
+    }
+}
+
+/* Turns a whole binary output back into text, just as the search would have
+ * printed it.  Throws std::runtime_error if 'in' is garbage. */
+void decode_binary(std::istream& in, std::ostream& out) {
+    std::unique_ptr<function> f;
+    myint width = 0;
+    char bytes[BINARY_HEADER_SIZE];
+    while (in.peek() != std::char_traits<char>::eof()) {
+        if (in.peek() == BINARY_MAGIC[0]) {
+            in.read(bytes, BINARY_HEADER_SIZE);
+            const myint num_inputs = static_cast<unsigned char>(bytes[5]);
+            const myint num_outputs = static_cast<unsigned char>(bytes[6]);
+            width = static_cast<unsigned char>(bytes[7]);
+            if (!in || !std::equal(bytes, bytes + 4, BINARY_MAGIC)
+                    || bytes[4] != BINARY_VERSION) {
+                throw std::runtime_error("bad header");
+            }
+            if (num_inputs < 1 || num_inputs > MAX_BITS || num_outputs < 1
+                    || num_outputs > MAX_BITS
+                    || width != bytes_per_place(num_outputs)) {
+                throw std::runtime_error("bad dimensions in header");
+            }
+            f.reset(new function(num_inputs, num_outputs));
+            continue;
+        }
+        if (!f) {
+            throw std::runtime_error("missing header");
+        }
+        for (myint& place : f->image) {
+            in.read(bytes, width);
+            if (!in) {
+                throw std::runtime_error("truncated function");
+            }
+            place = 0;
+            for (myint b = 0; b < width; ++b) {
+                place |= static_cast<myint>(
+                        static_cast<unsigned char>(bytes[b])) << (8 * b);
+            }
+            if (place >= f->end_output) {
+                throw std::runtime_error("place out of range");
+            }
+        }
+        out << "=> " << *f << '\n';
+    }
+    out.flush();
+}
+
+
+/* ----- Profiling ----- */
+
+/* A cheap timestamp.  Cycles where available, nanoseconds otherwise. */
+unsigned long long read_cycles() {
+#ifdef MCF_HAVE_RDTSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// What 'read_cycles' counts.
+#ifdef MCF_HAVE_RDTSC
+const static char* const CYCLES_UNIT = "cycles";
+#else
+const static char* const CYCLES_UNIT = "ns";
+#endif
+
+/* What one analyzer did, see '--profile'. */
+struct analyzer_profile {
+    size_t calls = 0;
+    // Calls saved by the 'verdict_cache'.
+    size_t skips = 0;
+    unsigned long long cycles = 0;
+    // How often was its proposal the minimum, i.e., taken?
+    size_t wins = 0;
+    // Sum of all places skipped by these, see 'print_profile'.
+    unsigned long long jump_places = 0;
+    // Most recent proposal.
+    bit_address proposed = bit_address(0, 0);
+
+    void merge(const analyzer_profile& other) {
+        calls += other.calls;
+        skips += other.skips;
+        cycles += other.cycles;
+        wins += other.wins;
+        jump_places += other.jump_places;
+    }
+};
+
+typedef std::vector<analyzer_profile> profile_t;
+
+void merge_profile(profile_t& into, const profile_t& from) {
+    into.resize(std::max(into.size(), from.size()));
+    for (size_t i = 0; i < from.size(); ++i) {
+        into[i].merge(from[i]);
+    }
+}
+
+
+/* ----- Progress ----- */
+/* Every so often, print a line of JSON to std::cerr, for monitoring:
+ *     {"elapsed":10.0,"steps":99942400,"steps_per_sec":9994240,"fns":4,
+ *      "prefix":[0,1,0,2,0,0,0,0],"covered":0.0123}
+ * 'prefix' are the most significant places of the current function, and
+ * 'covered' is an estimate of how many of all steps lie before it (see
+ * 'progress_gauge').  So 'elapsed / covered' estimates the total time, but
+ * the estimate is rough, especially early on. */
+
+const static myint PROGRESS_PREFIX_PLACES = 8;
+
+class progress_reporter {
+public:
+    progress_reporter(const unsigned interval) :
+            interval(interval), start(std::chrono::steady_clock::now()),
+            next_due(start + this->interval) {
+    }
+
+    bool enabled() const {
+        return interval.count() > 0;
+    }
+
+    bool due() const {
+        return enabled() && std::chrono::steady_clock::now() >= next_due;
+    }
+
+    std::chrono::steady_clock::time_point due_at() const {
+        return next_due;
+    }
+
+    /* Estimates 'covered' from the places of the current function. */
+    void set_gauge(std::function<double(const std::vector<myint>&)> g) {
+        gauge = std::move(g);
+    }
+
+    /* The search starts (or resumes) after this many steps.  Otherwise,
+     * 'steps_per_sec' would be nonsense after resuming. */
+    void start_from(const size_t steps) {
+        start_steps = steps;
+    }
+
+    template <typename image_t>
+    void report(const size_t steps, const myint fns, const image_t& image) {
+        const std::chrono::steady_clock::time_point now =
+                std::chrono::steady_clock::now();
+        const double elapsed =
+                std::chrono::duration<double>(now - start).count();
+        const std::vector<myint> places(image.begin(), image.end());
+        std::ostringstream buf;
+        buf << "{\"elapsed\":" << elapsed << ",\"steps\":" << steps
+                << ",\"steps_per_sec\":" << (steps - start_steps) / elapsed
+                << ",\"fns\":" << fns << ",\"prefix\":[";
+        for (size_t i = 0; i < places.size() && i < PROGRESS_PREFIX_PLACES;
+                ++i) {
+            buf << (i ? "," : "") << places[i];
+        }
+        buf << "]";
+        if (gauge) {
+            buf << ",\"covered\":" << gauge(places);
+        }
+        buf << "}\n";
+        std::cerr << buf.str() << std::flush;
+        next_due = now + interval;
+    }
+
+private:
+    const std::chrono::seconds interval;
+    const std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point next_due;
+    size_t start_steps = 0;
+    std::function<double(const std::vector<myint>&)> gauge;
+};
+
+
+/* ----- Combining it all ----- */
+
+const static bool DEBUG_PRINT = false;
+
+/* How exactly to search.  Unless noted otherwise, none of this changes the
+ * results. */
+struct search_options {
+    // Use the separate analyzers instead of 'fused_analyzer'.
+    bool separate = false;
+    // With 'separate', chain them at compile time, see 'pipeline'.
+    bool pipeline = false;
+    /* Don't use compile-time dimensions or packed images, even if
+     * available. */
+    bool generic = false;
+    // Use bit-sliced images and analyzers, see 'sliced_function'.
+    bool sliced = false;
+    /* Keep only one function of each class under input permutations.  This
+     * obviously *does* change the results. */
+    bool input_order = false;
+    /* Keep only one function of each class under flipping input pins (and
+     * restoring 'f(0) == 0').  Changes the results, too. */
+    bool input_flips = false;
+    /* Don't search, but count the functions and their classes under the
+     * above, see 'print_classes'. */
+    bool count_classes = false;
+    /* Skip functions where an output pin is a copy of an input pin.  This,
+     * too, changes the results. */
+    bool no_copies = false;
+    /* Skip values that are inadmissible from the lower neighbours alone,
+     * see 'advance_admissible'.  Same functions, fewer steps. */
+    bool admissible = false;
+    /* Don't print the functions, just count them.  Saves all the iostream
+     * formatting. */
+    bool count_only = false;
+    /* Stop after finding this many functions (in total, when resuming), or
+     * never if 0. */
+    myint limit = 0;
+    // Print found functions in binary, see 'write_binary'.
+    bool binary = false;
+    // Collect and print statistics about each analyzer, see 'print_profile'.
+    bool profile = false;
+
+    /* Only walk the 'shard'-th of 'num_shards' parts of the search space,
+     * and write it down for '--merge', see 'run_shard'.  0 means no
+     * sharding. */
+    myint shard = 0;
+    myint num_shards = 0;
+    /* If not 0, the shard covers the prefixes [plan_begin, plan_end) of the
+     * first 'plan_depth' places, see 'read_plan'.  Otherwise, it's an even
+     * split. */
+    myint plan_depth = 0;
+    prefix_t plan_begin = 0;
+    prefix_t plan_end = 0;
+
+    bool reached_limit(const myint fns) const {
+        return limit != 0 && fns >= limit;
+    }
+};
+
+/* Creates a fresh set of all analyzers, in the order in which they shall be
+ * consulted.
+ * HERE BE DRAGONS!  The analyzers are not really as independent as they
+ * may seem.  For instance, 'output_ordered' may sometimes (and
+ * inconsistently) enforce metastability-containment.  Thus, if you remove
+ * 'metastability_containing' from the list but leave 'output_ordered', you
+ * may be surprised by some/all functions being skipped. */
+properties_t make_properties(const function& f, const search_options& opts) {
+    properties_t properties;
+    if (opts.separate && opts.pipeline) {
+        properties.emplace_back(new separate_pipeline(f));
+    } else if (opts.separate) {
+        properties.emplace_back(new output_ordered(f));
+        properties.emplace_back(
+                new metastability_containing());
+        properties.emplace_back(new input_relevance(f));
+    } else if (opts.generic) {
+        properties.emplace_back(new fused_analyzer(f));
+    } else {
+        properties.emplace_back(make_fused_analyzer(f));
+    }
+    if (opts.no_copies) {
+        properties.emplace_back(new no_copies(f));
+    }
+    if (opts.input_order || opts.input_flips) {
+        properties.emplace_back(new input_ordered(f, opts.input_order,
+                opts.input_flips));
+    }
+    return properties;
+}
+
+/* The bit-sliced analyzers, in the same order as the separate ones. */
+basic_properties<sliced_function> make_properties(const sliced_function& f,
+        const search_options& opts) {
+    basic_properties<sliced_function> properties;
+    properties.emplace_back(new sliced_output_ordered(f));
+    properties.emplace_back(new sliced_metastability_containing(f));
+    properties.emplace_back(new sliced_input_relevance(f));
+    if (opts.no_copies) {
+        properties.emplace_back(new basic_no_copies<sliced_function>(f));
+    }
+    if (opts.input_order || opts.input_flips) {
+        properties.emplace_back(new basic_input_ordered<sliced_function>(f,
+                opts.input_order, opts.input_flips));
+    }
+    return properties;
+}
+
+/* Packed images are only supported by the fused analyzer. */
+template <typename place_t>
+basic_properties<basic_function<place_t>> make_properties(
+        const basic_function<place_t>& f, const search_options& opts) {
+    assert(!opts.separate && !opts.generic);
+    basic_properties<basic_function<place_t>> properties;
+    properties.emplace_back(make_fused_analyzer(f));
+    if (opts.no_copies) {
+        properties.emplace_back(
+                new basic_no_copies<basic_function<place_t>>(f));
+    }
+    if (opts.input_order || opts.input_flips) {
+        properties.emplace_back(
+                new basic_input_ordered<basic_function<place_t>>(f,
+                        opts.input_order, opts.input_flips));
+    }
+    return properties;
+}
+
+/* Remembers the last verdict of an analyzer, and whether it still holds.
+ * The searcher consults this before calling the analyzer; see
+ * 'basic_analyzer::settled_before'.
+ * In practice, only verdicts of satisfied analyzers survive a step: a
+ * complaint always depends on the place it complains about, and the search
+ * changes that place (or an earlier one) next. */
+struct verdict_cache {
+    template <typename function_t>
+    verdict_cache(const function_t& f) :
+            verdict(f), settled_before(f.end_input), pending(f.end_input) {
+    }
+
+    /* Has nothing before 'settled_before' changed, given that 'last_change'
+     * is the most significant place that changed in this step? */
+    bool holds(const myint last_change) {
+        pending = std::min(pending, last_change);
+        return pending >= settled_before;
+    }
+
+    /* The most significant place that changed since the analyzer was last
+     * called.  Resets that, as the analyzer is about to be called. */
+    myint take_pending(const myint end_input) {
+        const myint first_changed = pending;
+        pending = end_input;
+        return first_changed;
+    }
+
+    bit_address verdict;
+    myint settled_before;
+    myint pending;
+};
+
+/* Walks through the search space, one step at a time.  Remembers how far it
+ * got, so that different loops can drive it. */
+template <typename function_t>
+class searcher {
+public:
+    searcher(function_t& f, basic_properties<function_t>& properties,
+            const search_options& opts) :
+            f(f), properties(properties), opts(opts),
+            cached((opts.separate && !opts.pipeline) || opts.sliced),
+            caches(properties.size(), verdict_cache(f)) {
+    }
+
+    /* Analyzes the current function, prints it to 'out' (as 'opts' say) if
+     * it has all the desired properties, and advances to the next candidate.
+     * Returns the most significant place that changed, just like
+     * function::advance. */
+    myint step(std::ostream& out) {
+        if (DEBUG_PRINT) {
+            std::cerr << "#? " << f << std::endl;
+        }
+        ++steps;
+        bit_address next_change(f);
+
+        for (size_t i = 0; i < properties.size(); ++i) {
+            const bit_address proposed = analyze_cached(i);
+            if (DEBUG_PRINT) {
+                std::cerr << proposed << '\t';
+            }
+            next_change.assign_min(proposed);
+        }
+        if (DEBUG_PRINT) {
+            std::cerr << std::endl;
+        }
+        if (opts.profile) {
+            credit_winners(next_change);
+        }
+        if (next_change.input_pattern == f.end_input) {
+            // Yay!
+            if (opts.binary) {
+                write_binary(out, f);
+            } else if (!opts.count_only) {
+                out << "=> " << f << std::endl;
+            }
+            ++fns;
+            next_change.input_pattern = f.end_input - 1;
+            next_change.bit = 0;
+        }
+        last_change = opts.admissible ? f.advance_admissible(next_change)
+                : f.advance(next_change);
+        return last_change;
+    }
+
+    /* Has the search wrapped around, i.e., is it done? */
+    bool done() const {
+        return last_change >= f.end_input;
+    }
+
+    checkpoint save() const {
+        checkpoint cp;
+        cp.num_inputs = f.num_inputs;
+        cp.num_outputs = f.num_outputs;
+        cp.steps = steps;
+        cp.fns = fns;
+        if (done()) {
+            cp.last_change = 0;
+        } else {
+            cp.last_change = last_change;
+            cp.image.assign(f.image.begin(), f.image.end());
+            cp.states = save_states(properties);
+        }
+        return cp;
+    }
+
+    void load(const checkpoint& cp) {
+        assert(cp.num_inputs == f.num_inputs);
+        assert(cp.num_outputs == f.num_outputs);
+        steps = cp.steps;
+        fns = cp.fns;
+        caches.assign(properties.size(), verdict_cache(f));
+        if (cp.image.empty()) {
+            last_change = f.end_input;
+        } else {
+            f.set_image(cp.image.begin(), cp.image.end());
+            load_states(properties, cp.states, f);
+            last_change = cp.last_change;
+        }
+    }
+
+    function_t& f;
+    basic_properties<function_t>& properties;
+    const search_options& opts;
+    size_t steps = 0;
+    myint fns = 0;
+    myint last_change = 0;
+    // Only used with 'opts.profile'.  One entry per analyzer.
+    profile_t profile;
+
+private:
+    /* Only the separate analyzers (and their sliced versions) ever settle,
+     * see 'verdict_cache'.  The fused one and the pipeline include the
+     * metastability check, which depends on everything, so don't bother
+     * with the bookkeeping for them. */
+    const bool cached;
+    // One per analyzer.  Not part of checkpoints; 'load' starts afresh.
+    std::vector<verdict_cache> caches;
+
+    bit_address analyze_cached(const size_t i) {
+        if (!cached) {
+            return opts.profile ? analyze_profiled(i, last_change)
+                    : properties[i]->analyze(f, last_change);
+        }
+        verdict_cache& c = caches[i];
+        if (c.holds(last_change)) {
+            if (opts.profile) {
+                profile.resize(properties.size());
+                ++profile[i].skips;
+                profile[i].proposed = c.verdict;
+            }
+            return c.verdict;
+        }
+        const myint first_changed = c.take_pending(f.end_input);
+        c.verdict = opts.profile ? analyze_profiled(i, first_changed)
+                : properties[i]->analyze(f, first_changed);
+        c.settled_before = properties[i]->settled_before(f);
+        return c.verdict;
+    }
+
+    bit_address analyze_profiled(const size_t i, const myint first_changed) {
+        profile.resize(properties.size());
+        analyzer_profile& p = profile[i];
+        const unsigned long long start = read_cycles();
+        p.proposed = properties[i]->analyze(f, first_changed);
+        p.cycles += read_cycles() - start;
+        ++p.calls;
+        return p.proposed;
+    }
+
+    /* Every analyzer that proposed 'next_change' gets the credit, even if it
+     * has to share. */
+    void credit_winners(const bit_address& next_change) {
+        if (next_change.input_pattern == f.end_input) {
+            return;
+        }
+        for (analyzer_profile& p : profile) {
+            if (p.proposed.input_pattern == next_change.input_pattern
+                    && p.proposed.bit == next_change.bit) {
+                ++p.wins;
+                p.jump_places += f.end_input - 1 - next_change.input_pattern;
+            }
+        }
+    }
+};
+
+template <typename function_t>
+void print_properties(const basic_properties<function_t>& properties) {
+    std::cerr << "Searching for function with " << properties.size()
+            << " properties:";
+    std::cerr << std::endl;
+    for (const std::unique_ptr<basic_analyzer<function_t>>& a : properties) {
+        std::cerr << a->get_name();
+        if (DEBUG_PRINT) {
+            std::cerr << '\t';
+        } else {
+            std::cerr << std::endl;
+        }
+    }
+    if (DEBUG_PRINT) {
+        std::cerr << std::endl;
+    }
+}
+
+void print_impossible() {
+    std::cerr << "Impossibly many output pins."
+            "  Pruning whole search right away." << std::endl;
+}
+
+void print_limit(const myint limit) {
+    std::cerr << "Stopping at the limit of " << limit << " fns." << std::endl;
+}
+
+/* One line per analyzer: how often it was called, how long that took, how
+ * often its proposal was the one taken, and how many places that skipped on
+ * average.  (A place skipped near the front is worth a lot more than one near
+ * the end, of course.) */
+template <typename function_t>
+void print_profile(const basic_properties<function_t>& properties,
+        const profile_t& profile) {
+    boost::io::ios_flags_saver butler_flags(std::cerr);
+    boost::io::ios_precision_saver butler_precision(std::cerr);
+    std::cerr << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < profile.size(); ++i) {
+        const analyzer_profile& p = profile[i];
+        std::cerr << "Profile of " << properties[i]->get_name() << ": "
+                << p.calls << " calls (" << p.skips << " skipped), "
+                << p.cycles / std::max<size_t>(p.calls, 1) << ' ' << CYCLES_UNIT
+                << "/call, "
+                << p.wins << " wins, jumping "
+                << static_cast<double>(p.jump_places)
+                        / std::max<size_t>(p.wins, 1)
+                << " places on average." << std::endl;
+    }
+}
+
+void print_summary(const myint fns, const size_t steps) {
+    boost::io::ios_width_saver butler_width(std::cerr);
+    std::cerr << std::setw(0) << "Done searching.  Found "
+            << fns << " fns in " << steps << " steps." << std::endl;
+}
+
+const static size_t CHECKPOINT_POLL_MASK = (1 << 16) - 1;
+
+void flush_pending(std::ostringstream& pending) {
+    if (pending.tellp() > 0) {
+        std::cout << pending.str();
+        pending.str("");
+    }
+}
+
+/* Print all (remaining) functions with the desired properties to std::cout.
+ * Note that the 'properties' vector will not be changed, but its elements.
+ * Continues from 'resume' instead of the beginning, if given.
+ * Also prints some statistics to std::cerr. */
+template <typename function_t>
+void print_remaining(function_t& f, basic_properties<function_t>& properties,
+        const search_options& opts, checkpointer& checkpoints,
+        progress_reporter& progress, const checkpoint* resume) {
+    print_properties(properties);
+    searcher<function_t> s(f, properties, opts);
+    if (resume) {
+        s.load(*resume);
+    }
+    // Binary output is collected here, and written in big chunks.
+    std::ostringstream pending;
+    std::ostream& out = opts.binary ? pending : std::cout;
+    if (opts.binary) {
+        write_binary_header(std::cout, f.num_inputs, f.num_outputs);
+    }
+    progress.start_from(s.steps);
+    if (output_ordered::can_fit(f.num_outputs, f.end_input)) {
+        while (!s.done() && !opts.reached_limit(s.fns)) {
+            s.step(out);
+            if ((s.steps & CHECKPOINT_POLL_MASK) == 0) {
+                flush_pending(pending);
+                if (progress.due()) {
+                    progress.report(s.steps, s.fns, f.image);
+                }
+                if (checkpoints.due()) {
+                    checkpoints.write(s.save());
+                }
+            }
+        }
+        flush_pending(pending);
+        if (checkpoints.enabled()) {
+            checkpoints.write(s.save());
+        }
+        if (!s.done()) {
+            print_limit(opts.limit);
+        }
+    } else {
+        print_impossible();
+    }
+    if (opts.profile) {
+        print_profile(properties, s.profile);
+    }
+    print_summary(s.fns, s.steps);
+}
+
+
+/* ----- Sharding ----- */
+/* Splits a search across processes (or machines), without anyone
+ * coordinating them.  Prefixes of the image at a fixed 'depth' (see
+ * 'get_prefix') are split into contiguous ranges, and each shard walks its
+ * ranges on its own.
+ * '--merge' then follows the serial search through all the shard files, and
+ * reproduces its output and counts exactly.
+ *
+ * The fixed depth makes this easy: the serial search can only get into a
+ * range by changing one of the first 'depth' places, which resets all later
+ * ones.  So it enters at the start of some prefix.  Each shard records every
+ * such "boundary" it passes, and how far it got until then.  If the serial
+ * search enters at a boundary that the shard jumped over, '--merge' walks
+ * that part itself.
+ *
+ * A shard file looks like this:
+ *     MetaContFn shard 5
+ *     <num_inputs> <num_outputs> <depth> <input_order> <no_copies> <count_only>
+ *         <input_flips> <admissible>
+ *     range <first prefix> <end prefix>
+ *     at <prefix> <steps> <fns>
+ *     => fn(...)
+ *     ...
+ *     exit <prefix, or "done"> <steps> <fns>
+ *     range ...
+ * The steps and fns are counted from the start of the range. */
+
+struct shard_range {
+    prefix_t begin;
+    prefix_t end;
+};
+
+/* How many prefixes there are at 'depth', or 0 if that doesn't fit. */
+prefix_t count_prefixes(const function& f, const myint depth) {
+    prefix_t count = 1;
+    for (myint i = 0; i < depth; ++i) {
+        if (count > std::numeric_limits<prefix_t>::max() / f.end_output) {
+            return 0;
+        }
+        count *= f.end_output;
+    }
+    return count;
+}
+
+/* The smallest depth with at least 'wanted' prefixes, or 0 if there is
+ * none. */
+myint shard_depth(const function& f, const prefix_t wanted) {
+    for (myint depth = 1; depth < f.end_input; ++depth) {
+        const prefix_t count = count_prefixes(f, depth);
+        if (count == 0) {
+            break;
+        }
+        if (count >= wanted) {
+            return depth;
+        }
+    }
+    return 0;
+}
+
+/* The 'shard'-th of 'num_shards' equally sized ranges of 'count' prefixes.
+ * Note that the work is far from evenly spread across prefixes. */
+shard_range split_evenly(const myint shard, const myint num_shards,
+        const prefix_t count) {
+    const prefix_t quot = count / num_shards;
+    const prefix_t rem = count % num_shards;
+    shard_range r;
+    r.begin = quot * shard + rem * shard / num_shards;
+    r.end = quot * (shard + 1) + rem * (shard + 1) / num_shards;
+    return r;
+}
+
+void write_shard_header(std::ostream& out, const myint num_inputs,
+        const myint num_outputs, const myint depth,
+        const search_options& opts) {
+    out << "MetaContFn shard 5\n" << num_inputs << ' ' << num_outputs << ' '
+            << depth << ' ' << opts.input_order << ' ' << opts.no_copies << ' '
+            << opts.count_only << ' ' << opts.input_flips << ' '
+            << opts.admissible << '\n';
+}
+
+/* Walks all of 'r', starting at its first prefix, and writes it down (see
+ * above) to 'out'. */
+template <typename function_t>
+void walk_shard_range(std::ostream& out, const myint num_inputs,
+        const myint num_outputs, const myint depth, const shard_range& r, const search_options& opts,
+        progress_reporter& progress, size_t& steps, myint& fns,
+        profile_t& profile) {
+    function_t f(num_inputs, num_outputs);
+    f.set_prefix(depth, r.begin);
+    basic_properties<function_t> properties = make_properties(f, opts);
+    searcher<function_t> s(f, properties, opts);
+    out << "range " << r.begin << ' ' << r.end << '\n';
+    for (;;) {
+        if (s.done()) {
+            out << "exit done";
+            break;
+        }
+        const prefix_t prefix = f.get_prefix(depth);
+        if (prefix >= r.end) {
+            out << "exit " << prefix;
+            break;
+        }
+        out << "at " << prefix << ' ' << s.steps << ' ' << s.fns
+                << '\n';
+        do {
+            s.step(out);
+            if (((steps + s.steps) & CHECKPOINT_POLL_MASK) == 0
+                    && progress.due()) {
+                progress.report(steps + s.steps, fns + s.fns, f.image);
+            }
+        } while (!s.done() && s.last_change > depth);
+    }
+    out << ' ' << s.steps << ' ' << s.fns << '\n';
+    steps += s.steps;
+    fns += s.fns;
+    merge_profile(profile, s.profile);
+}
+
+/* Walks the 'shard'-th of 'num_shards' parts of the search space, and writes
+ * it down for '--merge'.  The summary at the end only counts what this
+ * shard walked, which includes parts that the serial search would skip. */
+template <typename function_t>
+void run_shard(const myint num_inputs, const myint num_outputs,
+        const search_options& opts, progress_reporter& progress) {
+    const function_t zero(num_inputs, num_outputs);
+    print_properties(make_properties(zero, opts));
+    const function shape(num_inputs, num_outputs);
+    myint depth = opts.plan_depth;
+    shard_range r = {opts.plan_begin, opts.plan_end};
+    if (depth == 0) {
+        depth = shard_depth(shape, opts.num_shards);
+        assert(depth > 0); // checked by main
+        r = split_evenly(opts.shard, opts.num_shards,
+                count_prefixes(shape, depth));
+    }
+    std::cerr << "Shard " << opts.shard << '/' << opts.num_shards
+            << ": prefixes [" << r.begin << ", " << r.end << ") at depth "
+            << depth << '.' << std::endl;
+    write_shard_header(std::cout, num_inputs, num_outputs, depth, opts);
+    size_t steps = 0;
+    myint fns = 0;
+    profile_t profile;
+    if (!output_ordered::can_fit(num_outputs, zero.end_input)) {
+        // '--merge' finds out on its own.
+        print_impossible();
+    } else if (r.begin < r.end) {
+        progress.start_from(0);
+        walk_shard_range<function_t>(std::cout, num_inputs, num_outputs,
+                depth, r, opts, progress, steps, fns, profile);
+    }
+    std::cout.flush();
+    if (!std::cout) {
+        throw std::runtime_error("can't write shard");
+    }
+    if (opts.profile) {
+        print_profile(make_properties(zero, opts), profile);
+    }
+    print_summary(fns, steps);
+}
+
+/* Everything '--merge' needs to know about a range, except the functions
+ * found, which stay in the file until needed. */
+struct shard_walk {
+    size_t file;
+    shard_range range;
+    // Where the shard left the range, or 'done'.
+    bool done;
+    prefix_t exit;
+    size_t exit_steps;
+    myint exit_fns;
+};
+
+struct shard_boundary {
+    size_t walk;
+    size_t steps;
+    myint fns;
+    // Where the functions found after this boundary start in the file.
+    std::streampos found;
+};
+
+/* Reads the shard files, and reproduces the output and summary of the serial
+ * search from them.  Throws std::runtime_error if the files are garbage or
+ * don't cover the whole search space exactly once. */
+class shard_merger {
+public:
+    shard_merger(const std::vector<std::string>& filenames) :
+            names(filenames) {
+        if (filenames.empty()) {
+            throw std::runtime_error("no shard files given");
+        }
+        for (const std::string& filename : filenames) {
+            shards.emplace_back(new std::ifstream(filename.c_str()));
+        }
+        for (size_t i = 0; i < shards.size(); ++i) {
+            read_index(i);
+        }
+    }
+
+    /* Same, but for shards that are still in memory.  'names' are only for
+     * error messages. */
+    shard_merger(std::vector<std::unique_ptr<std::istream>>&& shards,
+            const std::vector<std::string>& names) :
+            names(names), shards(std::move(shards)) {
+        for (size_t i = 0; i < this->shards.size(); ++i) {
+            read_index(i);
+        }
+    }
+
+    void print_params() const {
+        std::cerr << "n_in = " << num_inputs << ", n_out = " << num_outputs
+                << ", merging " << shards.size() << " shards." << std::endl;
+    }
+
+    void print_merged() {
+        const function zero(num_inputs, num_outputs);
+        if (!output_ordered::can_fit(num_outputs, zero.end_input)) {
+            print_impossible();
+            print_summary(0, 0);
+            return;
+        }
+        check_coverage(zero);
+        size_t steps = 0;
+        myint fns = 0;
+        bool done = false;
+        prefix_t pos = 0;
+        while (!done) {
+            const std::map<prefix_t, shard_boundary>::const_iterator it =
+                    boundaries.find(pos);
+            if (it == boundaries.end()) {
+                done = walk_gap(pos, steps, fns);
+                continue;
+            }
+            const shard_boundary& b = it->second;
+            const shard_walk& w = walks[b.walk];
+            copy_found(w.file, b.found);
+            steps += w.exit_steps - b.steps;
+            fns += w.exit_fns - b.fns;
+            done = w.done;
+            pos = w.exit;
+        }
+        print_summary(fns, steps);
+    }
+
+private:
+    void read_index(const size_t file) {
+        const std::string& filename = names[file];
+        std::istream& in = *shards[file];
+        std::string line;
+        if (!std::getline(in, line) || line != "MetaContFn shard 5") {
+            throw std::runtime_error("not a shard: " + filename);
+        }
+        myint header[8];
+        for (myint& value : header) {
+            in >> value;
+        }
+        std::getline(in, line);
+        if (!in) {
+            throw std::runtime_error("bad shard header in " + filename);
+        }
+        if (file == 0) {
+            num_inputs = header[0];
+            num_outputs = header[1];
+            depth = header[2];
+            opts.input_order = header[3];
+            opts.no_copies = header[4];
+            opts.count_only = header[5];
+            opts.input_flips = header[6];
+            opts.admissible = header[7];
+            if (num_inputs < 1 || num_inputs > MAX_BITS || num_outputs < 1
+                    || num_outputs > MAX_BITS || depth < 1
+                    || depth >= pin2mask(num_inputs)) {
+                throw std::runtime_error("bad shard header in " + filename);
+            }
+        } else if (header[0] != num_inputs || header[1] != num_outputs
+                || header[2] != depth || header[3] != opts.input_order
+                || header[4] != opts.no_copies
+                || header[5] != opts.count_only
+                || header[6] != opts.input_flips
+                || header[7] != opts.admissible) {
+            throw std::runtime_error(filename
+                    + " was searched differently than " + names[0]);
+        }
+        shard_walk* walk = nullptr;
+        while (std::getline(in, line)) {
+            if (line.compare(0, 3, "=> ") == 0) {
+                continue;
+            }
+            std::istringstream buf(line);
+            std::string kind;
+            buf >> kind;
+            if (kind == "range" && !walk) {
+                walks.emplace_back();
+                walk = &walks.back();
+                walk->file = file;
+                buf >> walk->range.begin >> walk->range.end;
+            } else if (kind == "at" && walk) {
+                prefix_t prefix;
+                shard_boundary b;
+                b.walk = walks.size() - 1;
+                buf >> prefix >> b.steps >> b.fns;
+                b.found = in.tellg();
+                if (!boundaries.emplace(prefix, b).second) {
+                    throw std::runtime_error("prefix walked twice in "
+                            + filename);
+                }
+            } else if (kind == "exit" && walk) {
+                std::string exit;
+                buf >> exit >> walk->exit_steps >> walk->exit_fns;
+                walk->done = (exit == "done");
+                walk->exit = walk->done ? 0 : std::stoull(exit);
+                walk = nullptr;
+            } else {
+                throw std::runtime_error("garbage in " + filename + ": "
+                        + line);
+            }
+            if (!buf) {
+                throw std::runtime_error("garbage in " + filename + ": "
+                        + line);
+            }
+        }
+        if (walk) {
+            throw std::runtime_error("truncated shard " + filename);
+        }
+    }
+
+    void check_coverage(const function& zero) const {
+        std::map<prefix_t, prefix_t> ranges;
+        for (const shard_walk& w : walks) {
+            ranges[w.range.begin] = w.range.end;
+        }
+        prefix_t covered = 0;
+        for (const std::pair<const prefix_t, prefix_t>& r : ranges) {
+            if (r.first != covered) {
+                throw std::runtime_error("shards don't cover the search space"
+                        " exactly once; is one missing?");
+            }
+            covered = r.second;
+        }
+        if (covered != count_prefixes(zero, depth)
+                || ranges.size() != walks.size()) {
+            throw std::runtime_error("shards don't cover the search space"
+                    " exactly once; is one missing?");
+        }
+    }
+
+    /* Copies the functions found after 'from' up to the end of its range. */
+    void copy_found(const size_t file, const std::streampos from) const {
+        std::istream& in = *shards[file];
+        in.clear();
+        in.seekg(from);
+        std::string line;
+        while (std::getline(in, line) && line.compare(0, 5, "exit ") != 0) {
+            if (line.compare(0, 3, "=> ") == 0) {
+                std::cout << line << '\n';
+            }
+        }
+        if (!in) {
+            throw std::runtime_error("truncated shard " + names[file]);
+        }
+    }
+
+    /* The serial search gets to 'pos', but no shard went there.  So walk to
+     * the next boundary.  Returns whether the search is done. */
+    bool walk_gap(prefix_t& pos, size_t& steps, myint& fns) {
+        function f(num_inputs, num_outputs);
+        f.set_prefix(depth, pos);
+        properties_t properties = make_properties(f, opts);
+        searcher<function> s(f, properties, opts);
+        do {
+            s.step(std::cout);
+        } while (!s.done() && s.last_change > depth);
+        steps += s.steps;
+        fns += s.fns;
+        if (s.done()) {
+            return true;
+        }
+        pos = f.get_prefix(depth);
+        return false;
+    }
+
+    const std::vector<std::string> names;
+    std::vector<std::unique_ptr<std::istream>> shards;
+    myint num_inputs = 0;
+    myint num_outputs = 0;
+    myint depth = 0;
+    search_options opts;
+    std::vector<shard_walk> walks;
+    std::map<prefix_t, shard_boundary> boundaries;
+};
+
+
+/* ----- Estimating ----- */
+/* How long would a search take?  Knuth's trick: walk down a random path of
+ * the search tree, and pretend that all siblings of each node on that path
+ * look just like it.  Averaged over many such probes, this estimates the size
+ * of the whole tree.
+ *
+ * Here, a node is a prefix of the image, and its children are the values of
+ * the next place (with --admissible, only those that 'advance_admissible'
+ * would try).  The search enters a child with all less significant places
+ * at 0, so that's how the children are analyzed, too.  If an analyzer
+ * complains about the child's place (or an earlier one), that's a single step
+ * of its own.  Otherwise, the child is "alive", and its subtree is unknown.
+ * Note that the search might skip some living children, namely if an analyzer
+ * complains about an earlier place from deep within a previous child.  So
+ * this rather overestimates. */
+
+struct estimate {
+    double steps;
+    double fns;
+};
+
+class estimator {
+public:
+    estimator(const myint num_inputs, const myint num_outputs,
+            const search_options& opts) :
+            f(num_inputs, num_outputs), properties(make_properties(f, opts)),
+            admissible(opts.admissible) {
+    }
+
+    /* A single random descent, below the prefix 'prefix' of the first
+     * 'depth' places (see 'get_prefix').  The prefix itself should be
+     * alive, see 'expand'. */
+    estimate probe(std::mt19937_64& rng, const myint depth = 0,
+            const prefix_t prefix = 0) {
+        start(depth, prefix);
+        return descend(rng, depth);
+    }
+
+    /* Same, but below whatever the first 'depth' places currently are.  The
+     * places after them must be 0. */
+    estimate descend(std::mt19937_64& rng, const myint depth) {
+        // How many nodes the current node stands for.
+        double weight = 1;
+        estimate e = {0, 0};
+        std::vector<myint> alive;
+        for (myint place = depth + 1; place < f.end_input; ++place) {
+            const myint rejected = expand(place, alive);
+            e.steps += weight * rejected;
+            if (place == f.end_input - 1) {
+                // Leaves.  Being alive here means being found.
+                e.steps += weight * alive.size();
+                e.fns += weight * alive.size();
+                break;
+            }
+            if (alive.empty()) {
+                break;
+            }
+            weight *= alive.size();
+            std::uniform_int_distribution<size_t> pick(0, alive.size() - 1);
+            set_place(place, alive[pick(rng)]);
+        }
+        return e;
+    }
+
+    /* Tries the values of 'place' (with all less significant places at 0,
+     * just like the search enters them), and collects the living ones into
+     * 'alive'.  Returns how many steps the others took. */
+    myint expand(const myint place, std::vector<myint>& alive) {
+        alive.clear();
+        myint rejected = 0;
+        // The search enters with 0, even if that's not admissible.
+        myint value = 0;
+        while (value < f.end_output) {
+            set_place(place, value);
+            const bit_address verdict = analyze();
+            myint next;
+            if (verdict.input_pattern > place) {
+                alive.push_back(value);
+                next = value + 1;
+            } else {
+                ++rejected;
+                if (verdict.input_pattern < place) {
+                    // Not only this child, but the whole node is dead.
+                    break;
+                }
+                next = (value | (pin2mask(verdict.bit) - 1)) + 1;
+            }
+            value = next_value(place, next);
+        }
+        return rejected;
+    }
+
+    /* Continues below the given prefix, see 'probe'. */
+    void start(const myint depth, const prefix_t prefix) {
+        f.set_prefix(depth, prefix);
+        changed = 0;
+    }
+
+    void set_place(const myint place, const myint value) {
+        f.image[place] = value;
+        changed = std::min(changed, place);
+    }
+
+    const function& get_function() const {
+        return f;
+    }
+
+private:
+    /* The first value of at least 'from' that the search would try at
+     * 'place', or something past 'f.end_output' if there is none. */
+    myint next_value(const myint place, const myint from) const {
+        return admissible ? f.next_admissible(place, from) : from;
+    }
+
+    bit_address analyze() {
+        bit_address verdict(f);
+        for (std::unique_ptr<analyzer>& a : properties) {
+            verdict.assign_min(a->analyze(f, changed));
+        }
+        changed = f.end_input;
+        return verdict;
+    }
+
+    function f;
+    properties_t properties;
+    const bool admissible;
+    // Most significant place that changed since the last 'analyze'.
+    myint changed = 0;
+};
+
+const static std::mt19937_64::result_type ESTIMATE_SEED = 42;
+// How many steps of the actual search 'measure_rate' times.
+const static size_t RATE_STEPS = 1 << 20;
+
+/* Runs the search itself for a moment, and returns how many steps it makes
+ * per second, or 0 if that was too quick to tell.  Probing is a different
+ * kind of work, so its own speed says little about that. */
+double measure_rate(const myint num_inputs, const myint num_outputs,
+        const search_options& opts) {
+    search_options quiet = opts;
+    quiet.count_only = true;
+    quiet.binary = false;
+    quiet.profile = false;
+    function f(num_inputs, num_outputs);
+    properties_t properties = make_properties(f, quiet);
+    searcher<function> s(f, properties, quiet);
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    while (!s.done() && s.steps < RATE_STEPS) {
+        s.step(std::cout);
+    }
+    const double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    return seconds > 0 ? s.steps / seconds : 0;
+}
+
+/* Prints an estimate of what print_remaining would find, and how many steps
+ * it would take.  Also, how long that would take on this machine. */
+void print_estimate(const myint num_inputs, const myint num_outputs,
+        const search_options& opts, const size_t probes) {
+    estimator est(num_inputs, num_outputs, opts);
+    print_properties(make_properties(function(num_inputs, num_outputs),
+            opts));
+    if (!output_ordered::can_fit(num_outputs, pin2mask(num_inputs))) {
+        print_impossible();
+        return;
+    }
+    std::mt19937_64 rng(ESTIMATE_SEED);
+    double sum_steps = 0, sum_sq_steps = 0, sum_fns = 0, sum_sq_fns = 0;
+    for (size_t i = 0; i < probes; ++i) {
+        const estimate e = est.probe(rng);
+        sum_steps += e.steps;
+        sum_sq_steps += e.steps * e.steps;
+        sum_fns += e.fns;
+        sum_sq_fns += e.fns * e.fns;
+    }
+
+    // Standard error of the mean, i.e., how much to trust this.
+    const double n = static_cast<double>(probes);
+    const double steps = sum_steps / n;
+    const double fns = sum_fns / n;
+    const double steps_err = std::sqrt(std::max(0.0,
+            sum_sq_steps / n - steps * steps) / n);
+    const double fns_err = std::sqrt(std::max(0.0,
+            sum_sq_fns / n - fns * fns) / n);
+    boost::io::ios_flags_saver butler_flags(std::cerr);
+    boost::io::ios_precision_saver butler_precision(std::cerr);
+    std::cerr << std::setprecision(3) << "Estimated " << fns << " (+- "
+            << fns_err << ") fns in " << steps << " (+- " << steps_err
+            << ") steps, from " << probes << " probes." << std::endl;
+    const double rate = measure_rate(num_inputs, num_outputs, opts);
+    if (rate > 0) {
+        std::cerr << "At " << rate << " steps/s, that's about "
+                << steps / rate / 3600 << " hours on a single thread."
+                << std::endl;
+    }
+}
+
+
+/* Estimates how many of all steps lie before a function, for
+ * 'progress_reporter'.  Just reading the image as a number is useless, as
+ * the search spends almost all of its time in a tiny part of that space.
+ * Instead, weigh each living value of a place by the estimated size of the
+ * search below it (see 'estimator'), and go down the places of the function:
+ * the values before its own add their share, and its own value narrows the
+ * share for the next place.  Stop once that share doesn't matter anymore.
+ * As the most significant places rarely change, the nodes along the
+ * current path are kept. */
+class progress_gauge {
+public:
+    progress_gauge(const myint num_inputs, const myint num_outputs,
+            const search_options& opts) :
+            est(num_inputs, num_outputs, opts) {
+    }
+
+    double covered(const std::vector<myint>& places) {
+        const myint end_input = est.get_function().end_input;
+        double covered = 0;
+        double share = 1;
+        for (myint place = 1; place < end_input && place < places.size()
+                && share >= GAUGE_MIN_SHARE; ++place) {
+            const node& n = expand(places, place, share);
+            double before = 0;
+            double own = 0;
+            for (const child& c : n.children) {
+                if (c.value < places[place]) {
+                    before += c.steps;
+                } else if (c.value == places[place]) {
+                    own = c.steps;
+                }
+            }
+            if (n.total <= 0) {
+                break;
+            }
+            covered += share * before / n.total;
+            share *= own / n.total;
+        }
+        return covered;
+    }
+
+private:
+    struct child {
+        myint value;
+        double steps;
+    };
+
+    struct node {
+        // The places before the expanded one.
+        std::vector<myint> prefix;
+        std::vector<child> children;
+        double total;
+    };
+
+    /* The living values of 'place' below the given places, with their
+     * estimated steps.  The estimates vary wildly, so spend more probes
+     * where it matters more, i.e. on bigger 'share's. */
+    const node& expand(const std::vector<myint>& places, const myint place,
+            const double share) {
+        if (path.size() >= place && std::equal(places.begin() + 1,
+                places.begin() + place, path[place - 1].prefix.begin() + 1)) {
+            return path[place - 1];
+        }
+        path.resize(place - 1);
+        node n;
+        n.prefix.assign(places.begin(), places.begin() + place);
+        n.total = 0;
+        const size_t probes = std::max(GAUGE_MIN_PROBES,
+                static_cast<size_t>(GAUGE_MAX_PROBES * share));
+        std::vector<myint> alive;
+        go_to(n.prefix);
+        est.expand(place, alive);
+        for (const myint value : alive) {
+            double sum = 0;
+            for (size_t i = 0; i < probes; ++i) {
+                go_to(n.prefix);
+                est.set_place(place, value);
+                sum += est.descend(rng, place).steps;
+            }
+            const child c = {value, 1 + sum / probes};
+            n.children.push_back(c);
+            n.total += c.steps;
+        }
+        path.push_back(std::move(n));
+        return path.back();
+    }
+
+    /* Sets the estimator to exactly these places, and 0 after them. */
+    void go_to(const std::vector<myint>& prefix) {
+        est.start(0, 0);
+        for (myint i = 1; i < prefix.size(); ++i) {
+            est.set_place(i, prefix[i]);
+        }
+    }
+
+    // Probes per living value, at a share of 1 and at the very least.
+    static const size_t GAUGE_MAX_PROBES = 1 << 12;
+    static const size_t GAUGE_MIN_PROBES = 16;
+    // Don't bother with places that narrow it down further than this.
+    static constexpr double GAUGE_MIN_SHARE = 1e-6;
+
+    estimator est;
+    std::mt19937_64 rng{ESTIMATE_SEED};
+    // path[i] is the node expanding place 'i + 1'.
+    std::vector<node> path;
+};
+
+/* ----- Planning ----- */
+/* Splitting the prefixes evenly (see 'split_evenly') makes for terrible
+ * shards: 'output_ordered' kills most prefixes right away, and the rest
+ * differ wildly.  So instead, go as deep as needed to find enough prefixes
+ * that survive the analyzers (just like 'estimator' does), estimate the size
+ * of the search below each of them, and cut the list into ranges of about
+ * the same estimated size.
+ * The plan is written to a plain text file:
+ *     MetaContFn plan 1
+ *     <num_inputs> <num_outputs> <depth> <num_shards>
+ *     <first prefix> <end prefix> <estimated steps>
+ *     ...
+ * with one line per shard, in order.  See '--plan'. */
+
+// Aim for this many surviving prefixes per shard.
+const static size_t PLAN_PREFIXES_PER_SHARD = 16;
+// Don't look at more surviving prefixes than this.
+const static size_t PLAN_MAX_PREFIXES = 1 << 20;
+const static size_t DEFAULT_PLAN_PROBES = 64;
+
+struct shard_plan {
+    myint num_inputs;
+    myint num_outputs;
+    myint depth;
+    std::vector<shard_range> ranges;
+    std::vector<double> steps;
+};
+
+class planner {
+public:
+    planner(const myint num_inputs, const myint num_outputs,
+            const search_options& opts) :
+            est(num_inputs, num_outputs, opts) {
+    }
+
+    /* All prefixes of the first 'depth' places that the analyzers don't
+     * reject, in order.  Gives up after 'limit' of them. */
+    std::vector<prefix_t> surviving(const myint depth, const size_t limit) {
+        std::vector<prefix_t> found;
+        est.start(0, 0);
+        collect(1, depth, limit, found);
+        return found;
+    }
+
+    shard_plan make(const myint num_shards, const size_t probes) {
+        const function& f = est.get_function();
+        shard_plan plan;
+        plan.num_inputs = f.num_inputs;
+        plan.num_outputs = f.num_outputs;
+        std::vector<prefix_t> prefixes;
+        plan.depth = 0;
+        for (myint depth = 1; depth + 1 < f.end_input
+                && count_prefixes(f, depth) != 0; ++depth) {
+            std::vector<prefix_t> deeper = surviving(depth, PLAN_MAX_PREFIXES);
+            if (deeper.size() >= PLAN_MAX_PREFIXES) {
+                // Too many to look at, so stay at the previous depth.
+                break;
+            }
+            plan.depth = depth;
+            prefixes.swap(deeper);
+            if (prefixes.size() >= num_shards * PLAN_PREFIXES_PER_SHARD) {
+                break;
+            }
+        }
+        if (prefixes.size() < num_shards) {
+            throw std::runtime_error("only " + std::to_string(prefixes.size())
+                    + " prefixes survive, so use fewer shards");
+        }
+        std::cerr << prefixes.size() << " prefixes survive at depth "
+                << plan.depth << ", estimating " << probes
+                << " probes each." << std::endl;
+
+        std::vector<double> sizes(prefixes.size());
+        double total = 0;
+        for (size_t i = 0; i < prefixes.size(); ++i) {
+            double sum = 0;
+            for (size_t j = 0; j < probes; ++j) {
+                sum += est.probe(rng, plan.depth, prefixes[i]).steps;
+            }
+            // Walking into the prefix is a step, too.
+            sizes[i] = 1 + sum / probes;
+            total += sizes[i];
+        }
+
+        /* Each shard takes prefixes until it has about its share of the
+         * total (counting from the very beginning, so that errors don't add
+         * up).  Leave at least one prefix for each remaining shard. */
+        size_t next = 0;
+        double before = 0;
+        for (myint shard = 0; shard < num_shards; ++shard) {
+            const size_t first = next;
+            const size_t end = prefixes.size() - (num_shards - shard - 1);
+            const double share = total * (shard + 1) / num_shards;
+            const bool last = (shard + 1 == num_shards);
+            double steps = 0;
+            do {
+                steps += sizes[next];
+                ++next;
+            } while (next < end
+                    && (last || before + steps + sizes[next] / 2 <= share));
+            before += steps;
+            shard_range r;
+            r.begin = (shard == 0) ? 0 : prefixes[first];
+            r.end = last ? count_prefixes(f, plan.depth) : prefixes[next];
+            plan.ranges.push_back(r);
+            plan.steps.push_back(steps);
+        }
+        return plan;
+    }
+
+private:
+    void collect(const myint place, const myint depth, const size_t limit,
+            std::vector<prefix_t>& found) {
+        std::vector<myint> alive;
+        est.expand(place, alive);
+        for (const myint value : alive) {
+            if (found.size() >= limit) {
+                break;
+            }
+            est.set_place(place, value);
+            if (place == depth) {
+                found.push_back(est.get_function().get_prefix(depth));
+            } else {
+                collect(place + 1, depth, limit, found);
+            }
+        }
+        est.set_place(place, 0);
+    }
+
+    estimator est;
+    std::mt19937_64 rng{ESTIMATE_SEED};
+};
+
+void write_plan(std::ostream& out, const shard_plan& plan) {
+    out << "MetaContFn plan 1\n" << plan.num_inputs << ' ' << plan.num_outputs
+            << ' ' << plan.depth << ' ' << plan.ranges.size() << '\n';
+    for (size_t i = 0; i < plan.ranges.size(); ++i) {
+        out << plan.ranges[i].begin << ' ' << plan.ranges[i].end << ' '
+                << plan.steps[i] << '\n';
+    }
+}
+
+shard_plan read_plan(const std::string& filename) {
+    std::ifstream in(filename.c_str());
+    std::string line;
+    if (!std::getline(in, line) || line != "MetaContFn plan 1") {
+        throw std::runtime_error("not a plan: " + filename);
+    }
+    shard_plan plan;
+    size_t num_shards;
+    in >> plan.num_inputs >> plan.num_outputs >> plan.depth >> num_shards;
+    if (!in || plan.num_inputs < 1 || plan.num_inputs > MAX_BITS
+            || plan.num_outputs < 1 || plan.num_outputs > MAX_BITS
+            || plan.depth < 1 || plan.depth + 1 >= pin2mask(plan.num_inputs)) {
+        throw std::runtime_error("bad plan header in " + filename);
+    }
+    const function f(plan.num_inputs, plan.num_outputs);
+    prefix_t covered = 0;
+    for (size_t i = 0; i < num_shards; ++i) {
+        shard_range r;
+        double steps;
+        in >> r.begin >> r.end >> steps;
+        if (!in || r.begin != covered || r.end <= r.begin) {
+            throw std::runtime_error("bad range in " + filename);
+        }
+        covered = r.end;
+        plan.ranges.push_back(r);
+        plan.steps.push_back(steps);
+    }
+    if (num_shards == 0 || covered != count_prefixes(f, plan.depth)) {
+        throw std::runtime_error("plan doesn't cover everything: " + filename);
+    }
+    return plan;
+}
+
+/* Writes a plan for 'num_shards' shards to std::cout. */
+void print_plan(const myint num_inputs, const myint num_outputs,
+        const search_options& opts, const myint num_shards,
+        const size_t probes) {
+    print_properties(make_properties(function(num_inputs, num_outputs),
+            opts));
+    if (!output_ordered::can_fit(num_outputs, pin2mask(num_inputs))) {
+        print_impossible();
+        return;
+    }
+    const shard_plan plan = planner(num_inputs, num_outputs, opts)
+            .make(num_shards, probes);
+    write_plan(std::cout, plan);
+    const std::pair<std::vector<double>::const_iterator,
+            std::vector<double>::const_iterator> extremes =
+            std::minmax_element(plan.steps.begin(), plan.steps.end());
+    boost::io::ios_precision_saver butler_precision(std::cerr);
+    std::cerr << std::setprecision(3) << "Shards range from about "
+            << *extremes.first << " to " << *extremes.second << " steps."
+            << std::endl;
+}
+
+
+/* ----- Searching in parallel ----- */
+/* Sharding within a single process:  plan a few ranges per thread (see
+ * 'planner'), let each thread walk whichever range is next into a shard of
+ * its own, and merge those when all are done (see 'shard_merger').  So the
+ * output and counts are exactly those of the serial search.
+ *
+ * This is the simplest thing that works, and it shows:
+ * - All output stays in memory until the end, so better use '--count-only'
+ *   for the big searches.
+ * - How evenly the threads are busy depends on the planner's estimates.
+ *   Several ranges per thread make up for some of their errors.
+ * - If a thread jumps over the place where the serial search enters the
+ *   next range, the merger walks that gap itself, after the threads.
+ * - No checkpoints, progress, '--limit' or '--binary'. */
+
+const static myint RANGES_PER_THREAD = 4;
+
+template <typename function_t>
+void print_parallel(const myint num_inputs, const myint num_outputs,
+        const myint num_threads, const search_options& opts,
+        checkpointer& checkpoints, progress_reporter& progress) {
+    shard_plan plan;
+    if (output_ordered::can_fit(num_outputs, pin2mask(num_inputs))) {
+        try {
+            plan = planner(num_inputs, num_outputs, opts).make(
+                    num_threads * RANGES_PER_THREAD, DEFAULT_PLAN_PROBES);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Can't split: " << e.what()
+                    << ".  Using a single thread." << std::endl;
+        }
+    }
+    if (plan.ranges.empty()) {
+        function_t f(num_inputs, num_outputs);
+        basic_properties<function_t> properties = make_properties(f, opts);
+        print_remaining(f, properties, opts, checkpoints, progress, nullptr);
+        return;
+    }
+    const function_t zero(num_inputs, num_outputs);
+    print_properties(make_properties(zero, opts));
+    std::cerr << "Walking " << plan.ranges.size() << " ranges with "
+            << num_threads << " threads." << std::endl;
+
+    std::vector<std::unique_ptr<std::istream>> shards;
+    std::vector<std::string> names;
+    std::vector<size_t> steps(num_threads, 0);
+    std::vector<myint> fns(num_threads, 0);
+    std::vector<profile_t> profiles(num_threads);
+    std::atomic<size_t> next_range{0};
+    std::vector<std::thread> workers;
+    for (myint i = 0; i < num_threads; ++i) {
+        std::stringstream* out = new std::stringstream;
+        shards.emplace_back(out);
+        names.push_back("thread " + std::to_string(i));
+        workers.emplace_back([&, i, out]() {
+            progress_reporter quiet(0);
+            write_shard_header(*out, num_inputs, num_outputs, plan.depth,
+                    opts);
+            for (size_t r = next_range++; r < plan.ranges.size();
+                    r = next_range++) {
+                walk_shard_range<function_t>(*out, num_inputs, num_outputs,
+                        plan.depth, plan.ranges[r], opts, quiet, steps[i],
+                        fns[i], profiles[i]);
+            }
+        });
+    }
+    size_t walked = 0;
+    profile_t profile;
+    for (myint i = 0; i < num_threads; ++i) {
+        workers[i].join();
+        walked += steps[i];
+        merge_profile(profile, profiles[i]);
+    }
+    std::cerr << "The threads walked " << walked << " steps." << std::endl;
+    if (opts.profile) {
+        print_profile(make_properties(zero, opts), profile);
+    }
+    shard_merger(std::move(shards), names).print_merged();
+}
+
+
+/* ----- Counting classes ----- */
+/* How many classes are there under input permutations and/or flips (see
+ * 'basic_input_ordered')?  '--input-order' and '--input-flips' visit one
+ * function per class, but then the raw count is lost.  Burnside's lemma gets
+ * both:  the number of classes is the average number of functions that a
+ * transform maps to themselves.  Searching for those fixed points is cheap,
+ * as 'basic_fixed_by' rejects nearly every prefix right away.  Only the
+ * identity needs the full search, and that's the raw count anyway.
+ *
+ * Also, conjugate transforms fix equally many functions, so one search per
+ * conjugacy class is enough.  Two permutations-and-flips are conjugate iff
+ * they have the same "signed cycle type":  the lengths of the cycles of the
+ * permutation of the pins, and whether each cycle flips an odd number of
+ * pins.  This holds even when only counting under permutations (or only
+ * under flips), as conjugating by any transform just maps fixed points to
+ * fixed points. */
+
+/* Each cycle as 2 * length, plus 1 if it flips an odd number of pins.
+ * Sorted. */
+typedef std::vector<myint> cycle_type;
+
+cycle_type signed_cycle_type(const std::vector<myint>& pins,
+        const myint flip) {
+    cycle_type type;
+    std::vector<bool> seen(pins.size());
+    for (myint start = 0; start < pins.size(); ++start) {
+        myint length = 0;
+        myint odd = 0;
+        for (myint pin = start; !seen[pin]; pin = pins[pin]) {
+            seen[pin] = true;
+            ++length;
+            odd ^= (flip >> pin) & 1;
+        }
+        if (length > 0) {
+            type.push_back(2 * length + odd);
+        }
+    }
+    std::sort(type.begin(), type.end());
+    return type;
+}
+
+struct conjugacy_class {
+    // How many transforms are in it.
+    size_t size = 0;
+    // One of them.
+    std::vector<myint> pins;
+    myint flip = 0;
+};
+
+/* Prints the number of functions, and the number of classes under input
+ * permutations (with 'opts.input_order') and/or flips (with
+ * 'opts.input_flips'), to std::cerr. */
+template <typename function_t>
+void print_classes(const myint num_inputs, const myint num_outputs,
+        const search_options& opts) {
+    search_options plain = opts;
+    plain.input_order = false;
+    plain.input_flips = false;
+    plain.count_only = true;
+    print_properties(make_properties(function_t(num_inputs, num_outputs),
+            plain));
+    if (!output_ordered::can_fit(num_outputs, pin2mask(num_inputs))) {
+        print_impossible();
+        return;
+    }
+
+    std::map<cycle_type, conjugacy_class> classes;
+    size_t num_transforms = 0;
+    std::vector<myint> pins(num_inputs);
+    for (myint pin = 0; pin < num_inputs; ++pin) {
+        pins[pin] = pin;
+    }
+    do {
+        for (myint t = 0; t < (opts.input_flips ? pin2mask(num_inputs) : 1);
+                ++t) {
+            conjugacy_class& c = classes[signed_cycle_type(pins, t)];
+            if (c.size++ == 0) {
+                c.pins = pins;
+                c.flip = t;
+            }
+            ++num_transforms;
+        }
+    } while (opts.input_order
+            && std::next_permutation(pins.begin(), pins.end()));
+    std::cerr << "Counting classes under " << num_transforms
+            << " transforms, in " << classes.size() << " conjugacy classes."
+            << std::endl;
+
+    myint raw = 0;
+    unsigned long long fixed = 0;
+    size_t steps = 0;
+    for (const std::pair<const cycle_type, conjugacy_class>& entry
+            : classes) {
+        const conjugacy_class& c = entry.second;
+        function_t f(num_inputs, num_outputs);
+        basic_properties<function_t> properties = make_properties(f, plain);
+        const bool identity = c.flip == 0
+                && std::is_sorted(c.pins.begin(), c.pins.end());
+        if (!identity) {
+            properties.emplace_back(new basic_fixed_by<function_t>(f,
+                    make_transform(c.pins, c.flip, f.end_input)));
+        }
+        searcher<function_t> s(f, properties, plain);
+        while (!s.done()) {
+            s.step(std::cout);
+        }
+        if (identity) {
+            raw = s.fns;
+        }
+        fixed += c.size * static_cast<unsigned long long>(s.fns);
+        steps += s.steps;
+        std::cerr << "Cycles";
+        for (const myint cycle : entry.first) {
+            std::cerr << ' ' << cycle / 2 << ((cycle & 1) ? "-" : "");
+        }
+        std::cerr << ": " << c.size << " transforms fix " << s.fns
+                << " fns each, in " << s.steps << " steps." << std::endl;
+    }
+    if (fixed % num_transforms != 0) {
+        throw std::runtime_error("fixed points don't add up, which is a bug");
+    }
+    std::cerr << "Done counting.  Found " << fixed / num_transforms
+            << " classes of " << raw << " fns in " << steps << " steps."
+            << std::endl;
+}
+
+
+/* ----- Calling it ----- */
+
+/* Searches everything, with the image stored as a 'function_t'.  Only the
+ * fused analyzer supports packed images, and only the sliced analyzers
+ * support sliced ones, see 'make_properties'. */
+template <typename function_t>
+void run_search(const myint num_inputs, const myint num_outputs,
+        const myint num_threads, const search_options& opts,
+        checkpointer& checkpoints, progress_reporter& progress,
+        const checkpoint* resume) {
+    if (opts.count_classes) {
+        print_classes<function_t>(num_inputs, num_outputs, opts);
+    } else if (opts.num_shards > 0) {
+        run_shard<function_t>(num_inputs, num_outputs, opts, progress);
+    } else if (num_threads > 1) {
+        print_parallel<function_t>(num_inputs, num_outputs, num_threads, opts,
+                checkpoints, progress);
+    } else {
+        function_t f(num_inputs, num_outputs);
+        basic_properties<function_t> properties = make_properties(f, opts);
+        print_remaining(f, properties, opts, checkpoints, progress, resume);
+    }
+}
+
+void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+            << " [<options>] [<num_inputs> [<num_outputs>]]\n"
+            "Options:\n"
+            "  --threads <n>           Search with <n> threads, 0 means one"
+            " per core.\n"
+            "  --checkpoint <file>     Periodically save progress to <file>.\n"
+            "  --checkpoint-interval <seconds>\n"
+            "                          How often to do that.  Defaults to "
+            << DEFAULT_CHECKPOINT_INTERVAL << ".\n"
+            "  --resume                Continue from the checkpoint file.\n"
+            "  --progress <seconds>    Print progress as JSON every <seconds>."
+            "  Off by\n"
+            "                          default.  Its \"covered\" is only a"
+            " rough estimate.\n"
+            "  --separate              Use the separate (reference) analyzers"
+            " instead\n"
+            "                          of the fused one.\n"
+            "  --pipeline              Use the separate analyzers, but chained"
+            " at compile\n"
+            "                          time.\n"
+            "  --generic               Don't use the fused analyzer with"
+            " compile-time\n"
+            "                          dimensions and packed images.\n"
+            "  --sliced                Use bit-sliced images and analyzers.\n"
+            "  --input-order           Only print the first function of each"
+            " class under\n"
+            "                          input permutations.\n"
+            "  --input-flips           Only print the first function of each"
+            " class under\n"
+            "                          flips of input pins.\n"
+            "  --no-copies             Skip functions where an output pin"
+            " copies an input\n"
+            "                          pin.\n"
+            "  --count-classes         Only count the functions, and their"
+            " classes under\n"
+            "                          --input-order and/or --input-flips.\n"
+            "  --admissible            Skip values that can't be"
+            " metastability-containing,\n"
+            "                          judging by their lower neighbours"
+            " alone.\n"
+            "  --count-only            Don't print the functions, only count"
+            " them.\n"
+            "  --limit <n>             Stop after finding <n> functions.\n"
+            "  --binary                Print the functions in binary.\n"
+            "  --decode                Read binary output from stdin, and print"
+            " it as text.\n"
+            "  --estimate <probes>     Don't search, but estimate how long it"
+            " would take,\n"
+            "                          using <probes> random probes.\n"
+            "  --profile               Print statistics about each analyzer"
+            " (with --separate,\n"
+            "                          about each part of the fused one).\n"
+            "  --shard <k>/<n>         Only search the <k>-th of <n> parts,"
+            " for --merge.\n"
+            "  --merge <files...>      Combine the outputs of --shard.\n"
+            "  --make-plan <n>         Don't search, but plan <n> balanced"
+            " shards.\n"
+            "  --plan <file>           Use that plan for --shard.\n"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+    myint num_inputs = 3;
+    myint num_outputs = 3;
+    myint num_threads = 1;
+    std::string checkpoint_file;
+    unsigned checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
+    // Off, unless asked for.
+    unsigned progress_interval = 0;
+    bool resume = false;
+    bool decode = false;
+    size_t estimate_probes = 0;
+    std::vector<std::string> merge_files;
+    myint plan_shards = 0;
+    std::string plan_file;
+    search_options opts;
+    myint positional = 0;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+            if (arg == "--threads" && has_value) {
+                num_threads = static_cast<myint>(std::stoul(argv[++i], nullptr,
+                        0));
+            } else if (arg == "--checkpoint" && has_value) {
+                checkpoint_file = argv[++i];
+            } else if (arg == "--checkpoint-interval" && has_value) {
+                checkpoint_interval = static_cast<unsigned>(std::stoul(
+                        argv[++i], nullptr, 0));
+            } else if (arg == "--progress" && has_value) {
+                progress_interval = static_cast<unsigned>(std::stoul(
+                        argv[++i], nullptr, 0));
+            } else if (arg == "--resume") {
+                resume = true;
+            } else if (arg == "--separate") {
+                opts.separate = true;
+            } else if (arg == "--pipeline") {
+                opts.separate = true;
+                opts.pipeline = true;
+            } else if (arg == "--sliced") {
+                opts.sliced = true;
+            } else if (arg == "--generic") {
+                opts.generic = true;
+            } else if (arg == "--input-order") {
+                opts.input_order = true;
+            } else if (arg == "--input-flips") {
+                opts.input_flips = true;
+            } else if (arg == "--no-copies") {
+                opts.no_copies = true;
+            } else if (arg == "--binary") {
+                opts.binary = true;
+            } else if (arg == "--decode") {
+                decode = true;
+            } else if (arg == "--estimate" && has_value) {
+                estimate_probes = std::stoul(argv[++i], nullptr, 0);
+            } else if (arg == "--profile") {
+                opts.profile = true;
+            } else if (arg == "--shard" && has_value) {
+                const std::string spec = argv[++i];
+                size_t slash = spec.find('/');
+                if (slash == std::string::npos) {
+                    throw std::invalid_argument("");
+                }
+                opts.shard = static_cast<myint>(std::stoul(
+                        spec.substr(0, slash), nullptr, 0));
+                opts.num_shards = static_cast<myint>(std::stoul(
+                        spec.substr(slash + 1), nullptr, 0));
+            } else if (arg == "--make-plan" && has_value) {
+                plan_shards = static_cast<myint>(std::stoul(argv[++i],
+                        nullptr, 0));
+            } else if (arg == "--plan" && has_value) {
+                plan_file = argv[++i];
+            } else if (arg == "--merge") {
+                merge_files.assign(argv + i + 1, argv + argc);
+                i = argc;
+            } else if (arg == "--count-classes") {
+                opts.count_classes = true;
+            } else if (arg == "--admissible") {
+                opts.admissible = true;
+            } else if (arg == "--count-only") {
+                opts.count_only = true;
+            } else if (arg == "--limit" && has_value) {
+                opts.limit = static_cast<myint>(std::stoul(argv[++i], nullptr,
+                        0));
+            } else if (arg.compare(0, 2, "--") == 0) {
+                std::cerr << "Unknown option " << arg << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            } else if (positional == 0) {
+                num_inputs = parse_arg(argv[i]);
+                ++positional;
+            } else if (positional == 1) {
+                num_outputs = parse_arg(argv[i]);
+                ++positional;
+            } else {
+                std::cerr << "Too many arguments." << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::invalid_argument& ia) {
+        std::cerr << "Arguments are non-numeric." << std::endl;
+        print_usage(argv[0]);
+        return 1;
+    } catch (const std::out_of_range& ia) {
+        std::cerr << "Arguments are too big; only [0, " << MAX_BITS
+                << "] is supported!" << std::endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (num_threads == 0) {
+        num_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    if (decode) {
+        try {
+            decode_binary(std::cin, std::cout);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Can't decode: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!merge_files.empty()) {
+        try {
+            shard_merger merger(merge_files);
+            merger.print_params();
+            merger.print_merged();
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Can't merge: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (opts.binary && opts.count_only) {
+        std::cerr << "--binary can't be combined with --count-only."
+                << std::endl;
+        return 1;
+    }
+    if (num_threads > 1 && (resume || !checkpoint_file.empty()
+            || opts.binary || opts.limit > 0 || progress_interval > 0)) {
+        std::cerr << "--threads can't be combined with --checkpoint,"
+                " --binary, --limit or --progress." << std::endl;
+        return 1;
+    }
+    if (!plan_file.empty() && opts.num_shards == 0) {
+        std::cerr << "--plan only makes sense with --shard." << std::endl;
+        return 1;
+    }
+    if (opts.num_shards > 0) {
+        if (opts.shard >= opts.num_shards) {
+            std::cerr << "There is no shard " << opts.shard << " of "
+                    << opts.num_shards << "; they count from 0." << std::endl;
+            return 1;
+        }
+        if (num_threads > 1 || resume || !checkpoint_file.empty()
+                || opts.binary || opts.limit > 0 || estimate_probes > 0) {
+            std::cerr << "--shard can't be combined with --threads,"
+                    " --checkpoint, --binary, --limit or --estimate."
+                    << std::endl;
+            return 1;
+        }
+        if (!plan_file.empty()) {
+            try {
+                const shard_plan plan = read_plan(plan_file);
+                if ((positional > 0 && num_inputs != plan.num_inputs)
+                        || (positional > 1 && num_outputs != plan.num_outputs)
+                        || plan.ranges.size() != opts.num_shards) {
+                    std::cerr << "Plan is for n_in = " << plan.num_inputs
+                            << ", n_out = " << plan.num_outputs << " with "
+                            << plan.ranges.size() << " shards." << std::endl;
+                    return 1;
+                }
+                num_inputs = plan.num_inputs;
+                num_outputs = plan.num_outputs;
+                opts.plan_depth = plan.depth;
+                opts.plan_begin = plan.ranges[opts.shard].begin;
+                opts.plan_end = plan.ranges[opts.shard].end;
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Can't read plan: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (shard_depth(function(num_inputs, num_outputs),
+                opts.num_shards) == 0) {
+            std::cerr << "Can't split into that many shards." << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<checkpoint> resume_from;
+    if (resume) {
+        if (checkpoint_file.empty()) {
+            std::cerr << "Can't resume without --checkpoint." << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+        try {
+            resume_from.reset(new checkpoint(read_checkpoint(checkpoint_file)));
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Can't resume: " << e.what() << std::endl;
+            return 1;
+        }
+        if ((positional > 0 && num_inputs != resume_from->num_inputs)
+                || (positional > 1 && num_outputs != resume_from->num_outputs)) {
+            std::cerr << "Checkpoint is for n_in = " << resume_from->num_inputs
+                    << ", n_out = " << resume_from->num_outputs << std::endl;
+            return 1;
+        }
+        num_inputs = resume_from->num_inputs;
+        num_outputs = resume_from->num_outputs;
+        std::cerr << "Resuming after " << resume_from->steps << " steps."
+                << std::endl;
+    }
+
+    if (opts.input_order && !opts.input_flips
+            && num_inputs > MAX_PERMUTED_INPUTS) {
+        std::cerr << "--input-order supports only up to "
+                << MAX_PERMUTED_INPUTS << " inputs." << std::endl;
+        return 1;
+    }
+    if (opts.input_flips && !opts.input_order
+            && num_inputs > MAX_FLIPPED_INPUTS) {
+        std::cerr << "--input-flips supports only up to "
+                << MAX_FLIPPED_INPUTS << " inputs." << std::endl;
+        return 1;
+    }
+    if (opts.input_order && opts.input_flips
+            && num_inputs > MAX_PERMUTED_FLIPPED_INPUTS) {
+        std::cerr << "--input-order with --input-flips supports only up to "
+                << MAX_PERMUTED_FLIPPED_INPUTS << " inputs." << std::endl;
+        return 1;
+    }
+
+    std::cerr << "n_in = " << num_inputs << ", n_out = " << num_outputs
+            << std::endl;
+
+    if (estimate_probes > 0) {
+        print_estimate(num_inputs, num_outputs, opts, estimate_probes);
+        return 0;
+    }
+
+    if (plan_shards > 0) {
+        try {
+            print_plan(num_inputs, num_outputs, opts, plan_shards,
+                    DEFAULT_PLAN_PROBES);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Can't plan: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (opts.count_classes) {
+        if (!opts.input_order && !opts.input_flips) {
+            std::cerr << "--count-classes needs --input-order and/or"
+                    " --input-flips." << std::endl;
+            return 1;
+        }
+        if (num_threads > 1 || resume || !checkpoint_file.empty()
+                || opts.binary || opts.limit > 0 || opts.num_shards > 0) {
+            std::cerr << "--count-classes can't be combined with --threads,"
+                    " --checkpoint, --binary, --limit or --shard."
+                    << std::endl;
+            return 1;
+        }
+    }
+
+    checkpointer checkpoints(checkpoint_file, checkpoint_interval);
+    progress_reporter progress(progress_interval);
+    std::unique_ptr<progress_gauge> gauge;
+    if (progress.enabled()) {
+        gauge.reset(new progress_gauge(num_inputs, num_outputs, opts));
+        progress.set_gauge([&gauge](const std::vector<myint>& places) {
+            return gauge->covered(places);
+        });
+    }
+    try {
+        if (opts.sliced) {
+            run_search<sliced_function>(num_inputs, num_outputs, num_threads,
+                    opts, checkpoints, progress, resume_from.get());
+        } else if (opts.separate || opts.generic || num_outputs > 16) {
+            run_search<function>(num_inputs, num_outputs, num_threads, opts,
+                    checkpoints, progress, resume_from.get());
+        } else if (num_outputs > 8) {
+            run_search<basic_function<std::uint16_t>>(num_inputs,
+                    num_outputs, num_threads, opts, checkpoints, progress,
+                    resume_from.get());
+        } else {
+            run_search<basic_function<std::uint8_t>>(num_inputs,
+                    num_outputs, num_threads, opts, checkpoints, progress,
+                    resume_from.get());
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << (opts.num_shards > 0 ? "Shard failed: "
+                : opts.count_classes ? "Can't count: "
+                : "Checkpoint failed: ") << e.what() << std::endl;
+        return 1;
+    }
 
     return 0;
 }